@@ -2,6 +2,7 @@
 # Expected usage: ./$0 $1 $2, $1 is path to file differ binary.
 #  and $2 is name (! not path) of the folder with files 
 #  named sourceX.txt and x1.txt, x2.txt, etc.
+#  Any other arguments are passed to the file differ.
 set -euo pipefail
 
 trap 'rm -rf $tmpname' EXIT
@@ -24,7 +25,7 @@ for file in "$dirname/$2/source"*.txt; do
     letter="${letter,}"
     for f in "$dirname/$2/$letter"*.txt; do
         testFailed=0
-        if ! ./"$1" "$file" "$f" > "$tmpname"/patch; then
+        if ! ./"$1" "${@:3}" "$file" "$f" > "$tmpname"/patch; then
             echo -e "$red""[!]$reset Failure when comparing $file -> $f" >&2
             testFailed=1
             result=1
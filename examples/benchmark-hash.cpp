@@ -0,0 +1,46 @@
+// Microbenchmark of line hashes: Utility::Murmur3 (32-bit) against Utility::Hash64.
+// Expected usage: make benchmark-hash
+// Lines are generated, always the same, with lengths typical for source code and logs.
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "../src/Utility.cpp"
+
+/// Hash every line [rounds] times, return throughput in MB/s. [sink] keeps the hashes from being optimized out.
+template<typename Hash>
+double measure(const std::vector<std::string_view> & lines, size_t bytes, int rounds, Hash hash, uint64_t & sink) {
+    auto start = std::chrono::steady_clock::now();
+    for (int round = 0; round < rounds; ++round)
+        for (const auto & line : lines) sink += hash(line);
+    std::chrono::duration<double> seconds = std::chrono::steady_clock::now() - start;
+    return (double)bytes * rounds / seconds.count() / 1e6;
+}
+
+int main() {
+    std::mt19937_64 random(42);
+    uint64_t sink = 0;
+    printf("%-24s %16s %16s\n", "line length", "Murmur3 (MB/s)", "Hash64 (MB/s)");
+    for (size_t maxLength : {8, 40, 120, 1000}) {
+        // About 64 MB of lines, of lengths <0; maxLength>
+        std::string text;
+        std::vector<std::pair<size_t, size_t>> ranges;
+        while (text.size() < (64 << 20) / (maxLength < 100 ? 4 : 1)) {
+            size_t length = random() % (maxLength + 1);
+            ranges.emplace_back(text.size(), length);
+            for (size_t i = 0; i < length; ++i) text.push_back((char)(' ' + random() % 95));
+        }
+        std::vector<std::string_view> lines;
+        for (const auto & range : ranges) lines.emplace_back(text.data() + range.first, range.second);
+
+        int rounds = 3;
+        double murmur = measure(lines, text.size(), rounds, [](std::string_view line) { return Utility::Murmur3(line); }, sink);
+        double hash64 = measure(lines, text.size(), rounds, [](std::string_view line) { return Utility::Hash64(line); }, sink);
+        printf("%-24s %16.0f %16.0f\n", ("up to " + std::to_string(maxLength)).c_str(), murmur, hash64);
+    }
+    fprintf(stderr, "checksum %llu\n", (unsigned long long)sink);
+    return 0;
+}
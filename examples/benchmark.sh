@@ -0,0 +1,106 @@
+#!/bin/bash
+# Expected usage: ./$0 $1 [$2], $1 is path to file differ binary,
+#  $2 is optional path to another (baseline) file differ binary,
+#  that is measured on the same cases for comparison.
+#  Inputs are generated in temporary folder, always the same.
+set -euo pipefail
+
+trap 'rm -rf $tmpname' EXIT
+
+tmpname="$(mktemp -d)"
+export LC_ALL=C
+
+# Generate pair of files $1 and $2 of $3 chunks, where about $4 percent of chunks
+# are modified, deleted or added. Chunks are random bytes if $5 is "binary", otherwise lines.
+generate() {
+    awk -v count="$3" -v percent="$4" -v kind="$5" -v a="$1" -v b="$2" 'BEGIN {
+        srand(42)
+        for (k = 0; k < count; k++) {
+            if (kind == "binary") chunk = sprintf("%c", 1 + int(rand() * 255))
+            else chunk = sprintf("%d %d %d\n", int(rand() * 1000000), k, int(rand() * 1000))
+            printf "%s", chunk > a
+            if (rand() * 100 >= percent) { printf "%s", chunk > b; continue }
+            edit = int(rand() * 3)
+            if (edit == 0) continue
+            if (kind == "binary") other = sprintf("%c", 1 + int(rand() * 255))
+            else other = sprintf("changed %d\n", int(rand() * 1000000))
+            if (edit == 1) printf "%s", other > b
+            else printf "%s%s", chunk, other > b
+        }
+    }'
+}
+
+# Generate pair of files $1 and $2, where $1 has $3 unique lines,
+# and $2 has the same lines, each followed by a new one.
+generateInterleaved() {
+    awk -v count="$3" -v a="$1" -v b="$2" 'BEGIN {
+        for (k = 0; k < count; k++) {
+            printf "line %d\n", k > a
+            printf "line %d\nnew %d\n", k, k > b
+        }
+    }'
+}
+
+# Generate pair of files $1 and $2, where $1 has one line, and $2 has $3 other lines.
+generateLopsided() {
+    awk -v count="$3" -v a="$1" -v b="$2" 'BEGIN {
+        printf "only line\n" > a
+        for (k = 0; k < count; k++) printf "line %d\n", k > b
+    }'
+}
+
+generate "$tmpname/bin-src" "$tmpname/bin-dst" 100000 1 binary
+generate "$tmpname/text-src" "$tmpname/text-dst" 20000 10 text
+generate "$tmpname/hunks-src" "$tmpname/hunks-dst" 300000 50 text
+generateInterleaved "$tmpname/interleaved-src" "$tmpname/interleaved-dst" 20000
+generateLopsided "$tmpname/lopsided-src" "$tmpname/lopsided-dst" 200000
+
+# Name of the case, followed by arguments of the file differ
+cases=(
+    "binary, precision 50|-F binary x -x 50 $tmpname/bin-src $tmpname/bin-dst"
+    "binary, precision 200|-F binary x -x 200 $tmpname/bin-src $tmpname/bin-dst"
+    "binary, adaptive|-F binary x $tmpname/bin-src $tmpname/bin-dst"
+    "text, precision 50|-x 50 $tmpname/text-src $tmpname/text-dst"
+    "text, precision 0|-x 0 $tmpname/text-src $tmpname/text-dst"
+    "text, adaptive|$tmpname/text-src $tmpname/text-dst"
+    "patch of ~150k hunks|-a patience $tmpname/hunks-src $tmpname/hunks-dst"
+    "graphical, ~150k hunks|-a patience -g $tmpname/hunks-src $tmpname/hunks-dst"
+    "histogram, 20k insertions|-a histogram $tmpname/interleaved-src $tmpname/interleaved-dst"
+    "myers, 1 vs 200k lines|-a myers $tmpname/lopsided-src $tmpname/lopsided-dst"
+)
+
+TIMEFORMAT="%R"
+printf "%-28s %20s" "case" "$1"
+[ $# -ge 2 ] && printf " %20s" "$2"
+printf "\n"
+for c in "${cases[@]}"; do
+    name="${c%%|*}"
+    read -r -a args <<< "${c#*|}"
+    printf "%-28s" "$name"
+    for binary in "${@:1:2}"; do
+        # Output goes to a file, the same way as when user saves a patch
+        seconds="$( { time "$binary" -p "${args[@]}" > "$tmpname/output" 2>/dev/null || true; } 2>&1 )"
+        printf " %19ss" "$seconds"
+    done
+    printf "\n"
+done
+
+# Time to first hunk, as logged by the file differ (not logged by builds that do not stream hunks)
+streamingCases=(
+    "text, split at anchors|--split-anchors $tmpname/text-src $tmpname/text-dst"
+    "text, adaptive|$tmpname/text-src $tmpname/text-dst"
+)
+
+printf "\n%-28s %20s" "first hunk" "$1"
+[ $# -ge 2 ] && printf " %20s" "$2"
+printf "\n"
+for c in "${streamingCases[@]}"; do
+    name="${c%%|*}"
+    read -r -a args <<< "${c#*|}"
+    printf "%-28s" "$name"
+    for binary in "${@:1:2}"; do
+        firstHunk="$( { "$binary" "${args[@]}" -v -p 2>&1 > /dev/null || true; } | grep -o "First hunk written after [0-9]* ms" | grep -o "[0-9]* ms" || echo "-" )"
+        printf " %20s" "$firstHunk"
+    done
+    printf "\n"
+done
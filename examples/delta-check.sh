@@ -0,0 +1,85 @@
+#!/bin/bash
+# Expected usage: ./$0 $1, $1 is path to file differ binary.
+#  Writes binary delta (--delta) between pairs of example files, applies it (--apply)
+#  to the source, and checks that the result is identical to the destination.
+#  Delta applied to another source than it was written for has to be rejected.
+set -euo pipefail
+
+trap 'rm -rf $tmpname' EXIT
+
+realpath="$(readlink -f "$0")"
+dirname="$(dirname "$realpath")"
+red="\e[91m"
+green="\e[92m"
+reset="\e[0m"
+
+result=0
+
+fail=0
+pass=0
+
+tmpname="$(mktemp -d)"
+text="$dirname/text"
+
+# Blocks of the destination are moved (and one of them duplicated) blocks of the source
+{ tail -c +12001 "$text/20k.txt"; head -c 4000 "$text/20k.txt"; head -c 12000 "$text/20k.txt" | tail -c +4001; \
+  head -c 2000 "$text/20k.txt"; } > "$tmpname"/moved
+# Source of the same size as 10k.txt, that differs in one byte
+{ head -c 5000 "$text/10k.txt"; printf '#'; tail -c +5002 "$text/10k.txt"; } > "$tmpname"/mismatched
+
+check() {
+    if ! ./"$1" --delta "$2" "$3" > "$tmpname"/delta; then
+        echo -e "$red""[!]$reset Failure when writing delta $2 -> $3" >&2
+        return 1
+    fi
+    if ! ./"$1" --apply "$2" "$tmpname"/delta > "$tmpname"/applied; then
+        echo -e "$red""[!]$reset Failure when applying delta $2 -> $3" >&2
+        return 1
+    fi
+    if ! cmp -s "$tmpname"/applied "$3"; then
+        echo -e "$red""[!]$reset FILE WAS NOT PATCHED SUCCESSFULLY: $2 -> $3" >&2
+        return 1
+    fi
+}
+
+checkRejected() {
+    ./"$1" --delta "$2" "$3" > "$tmpname"/delta
+    if ./"$1" --apply "$4" "$tmpname"/delta > /dev/null 2>&1; then
+        echo -e "$red""[!]$reset Delta $2 -> $3 was applied to another source $4" >&2
+        return 1
+    fi
+}
+
+cases=(
+    "$text/20k.txt" "$tmpname/moved"
+    "$text/10k.txt" "$text/10k.txt.modified"
+    "$text/Utility.tpp" "$text/Utility.tpp.new"
+    "$dirname/bin/1-source" "$dirname/bin/1-modif"
+    "$text/empty" "$text/10k.txt"
+    "$text/10k.txt" "$text/empty"
+    "$text/empty" "$text/empty"
+)
+for ((i = 0; i < ${#cases[@]}; i += 2)); do
+    if check "$1" "${cases[i]}" "${cases[i + 1]}"; then
+        pass=$((pass+1))
+    else
+        fail=$((fail+1))
+        result=1
+    fi
+done
+
+for source in "$text/20k.txt" "$text/empty" "$tmpname/mismatched"; do
+    if checkRejected "$1" "$text/10k.txt" "$text/10k.txt.modified" "$source"; then
+        pass=$((pass+1))
+    else
+        fail=$((fail+1))
+        result=1
+    fi
+done
+
+rm -rf "$tmpname"
+
+echo -e "Failed $red$fail$reset tests."
+echo -e "Passed $green$pass$reset tests."
+
+exit "$result"
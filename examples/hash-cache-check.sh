@@ -0,0 +1,85 @@
+#!/bin/bash
+# Expected usage: ./$0 $1, $1 is path to file differ binary.
+#  Compares example directories with --hash-cache, once with an empty cache
+#  and once with the cache filled by that run, and checks that both outputs
+#  are the same as without the cache. Then changes a file, that is the same
+#  in both directories, in place, and checks that its stale hash is not used.
+set -euo pipefail
+
+trap 'rm -rf $tmpname' EXIT
+
+realpath="$(readlink -f "$0")"
+dirname="$(dirname "$realpath")"
+binary="$(readlink -f "$1")"
+red="\e[91m"
+green="\e[92m"
+reset="\e[0m"
+
+result=0
+
+fail=0
+pass=0
+
+tmpname="$(mktemp -d)"
+
+check() {
+    local source="$1" destination="$2" options=("${@:3}")
+    # Copies, so that a file can be changed. Files modified just now are not cached (see HashCache),
+    # so the copies are made older.
+    rm -rf "${tmpname:?}"/source "${tmpname:?}"/destination "${tmpname:?}"/cache
+    cp -r "$source" "$tmpname"/source
+    cp -r "$destination" "$tmpname"/destination
+    find "$tmpname"/source "$tmpname"/destination -type f -exec touch -d "2001-01-01" {} +
+    source="$tmpname"/source
+    destination="$tmpname"/destination
+
+    "$binary" "${options[@]}" "$source" "$destination" > "$tmpname"/cold
+    # The directories differ, so an empty output would be the same with any cache
+    if [ ! -s "$tmpname"/cold ]; then
+        echo -e "$red""[!]$reset No difference found: ${options[*]} $1 -> $2" >&2
+        return 1
+    fi
+    for run in empty warm; do
+        "$binary" "${options[@]}" --hash-cache "$tmpname"/cache "$source" "$destination" > "$tmpname"/cached
+        if ! cmp -s "$tmpname"/cold "$tmpname"/cached; then
+            echo -e "$red""[!]$reset Output with $run cache differs: ${options[*]} $1 -> $2" >&2
+            return 1
+        fi
+    done
+
+    # The same size, other content and other (old enough) modification time
+    tr 'a-z' 'b-za' < "$source/$unchanged" > "$tmpname"/changed
+    cat "$tmpname"/changed > "$source/$unchanged"
+    touch -d "2000-01-01" "$source/$unchanged"
+    "$binary" "${options[@]}" "$source" "$destination" > "$tmpname"/cold
+    "$binary" "${options[@]}" --hash-cache "$tmpname"/cache "$source" "$destination" > "$tmpname"/cached
+    if ! cmp -s "$tmpname"/cold "$tmpname"/cached; then
+        echo -e "$red""[!]$reset Output with stale cache differs: ${options[*]} $1 -> $2" >&2
+        return 1
+    fi
+}
+
+# Directories, and a file that is the same in both of them
+pairs=(
+    "$dirname/filesystem/fs1" "$dirname/filesystem/fs2" "nested/bar"
+    "$dirname/recursive/files/source" "$dirname/recursive/files/destination" "nested/unchanged"
+)
+for options in "-p" "-p --renames" "-p -r"; do
+    for ((i = 0; i < ${#pairs[@]}; i += 3)); do
+        unchanged="${pairs[i + 2]}"
+        # shellcheck disable=SC2086
+        if check "${pairs[i]}" "${pairs[i + 1]}" $options; then
+            pass=$((pass+1))
+        else
+            fail=$((fail+1))
+            result=1
+        fi
+    done
+done
+
+rm -rf "$tmpname"
+
+echo -e "Failed $red$fail$reset tests."
+echo -e "Passed $green$pass$reset tests."
+
+exit "$result"
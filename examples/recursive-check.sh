@@ -0,0 +1,68 @@
+#!/bin/bash
+# Expected usage: ./$0 $1, $1 is path to file differ binary.
+#  Diffs each pair of directories recursive/*/source and recursive/*/destination
+#  with -r -p, applies the patch to a copy of the source, and checks that the copy
+#  is identical to the destination. The patch is applied by `patch -p1 -f`, and
+#  by `git apply`, if git is installed.
+set -euo pipefail
+
+trap 'rm -rf $tmpname' EXIT
+
+realpath="$(readlink -f "$0")"
+dirname="$(dirname "$realpath")"
+binary="$(readlink -f "$1")"
+red="\e[91m"
+green="\e[92m"
+reset="\e[0m"
+
+result=0
+
+fail=0
+pass=0
+
+tmpname="$(mktemp -d)"
+
+# GNU patch removes deleted files only after the whole patch is applied,
+# so it cannot create a directory in place of a file.
+patchSkipped="file-to-directory"
+
+check() {
+    local name="$1" applier="$2"
+    rm -rf "${tmpname:?}"/tree
+    cp -r "$dirname/recursive/$name/source" "$tmpname"/tree
+    if [ "$applier" = "patch" ]; then
+        (cd "$tmpname"/tree && patch -s -p1 -f -i "$tmpname"/patch) || return 1
+    else
+        (cd "$tmpname"/tree && git apply -p1 --unidiff-zero --whitespace=nowarn "$tmpname"/patch) || return 1
+    fi
+    diff -r "$tmpname"/tree "$dirname/recursive/$name/destination"
+}
+
+for pair in "$dirname"/recursive/*/; do
+    name="$(basename "$pair")"
+    # Relative names, so that -p1 strips the directory of either side
+    if ! (cd "$pair" && "$binary" -r -p source destination) > "$tmpname"/patch; then
+        echo -e "$red""[!]$reset Failure when comparing $name/source -> $name/destination" >&2
+        fail=$((fail+1))
+        result=1
+        continue
+    fi
+    for applier in patch git; do
+        if [ "$applier" = "patch" ] && [ "$name" = "$patchSkipped" ]; then continue; fi
+        if [ "$applier" = "git" ] && ! command -v git > /dev/null; then continue; fi
+        if check "$name" "$applier"; then
+            pass=$((pass+1))
+        else
+            echo -e "$red""[!]$reset DIRECTORY WAS NOT PATCHED SUCCESSFULLY by $applier: $name" >&2
+            fail=$((fail+1))
+            result=1
+        fi
+    done
+done
+
+rm -rf "$tmpname"
+
+echo -e "Failed $red$fail$reset tests."
+echo -e "Passed $green$pass$reset tests."
+
+exit "$result"
@@ -0,0 +1,51 @@
+#!/bin/bash
+# Expected usage: ./$0 $1, $1 is path to file differ binary.
+#  Compares directories renames/source and renames/destination with --renames,
+#  and checks that the listing is the same as renames/expected. Then checks
+#  that the patch written with -r -p --renames reproduces the destination.
+set -euo pipefail
+
+trap 'rm -rf $tmpname' EXIT
+
+realpath="$(readlink -f "$0")"
+dirname="$(dirname "$realpath")"
+binary="$(readlink -f "$1")"
+red="\e[91m"
+green="\e[92m"
+reset="\e[0m"
+
+result=0
+
+fail=0
+pass=0
+
+tmpname="$(mktemp -d)"
+renames="$dirname/renames"
+
+if "$binary" --renames "$renames"/source "$renames"/destination > "$tmpname"/listing \
+        && diff "$renames"/expected "$tmpname"/listing; then
+    pass=$((pass+1))
+else
+    echo -e "$red""[!]$reset Listing of renames differs from $renames/expected" >&2
+    fail=$((fail+1))
+    result=1
+fi
+
+# Moved entries are deleted and added by the patch
+cp -r "$renames"/source "$tmpname"/tree
+if (cd "$renames" && "$binary" -r -p --renames source destination) > "$tmpname"/patch \
+        && (cd "$tmpname"/tree && patch -s -p1 -f -i "$tmpname"/patch) \
+        && diff -r "$tmpname"/tree "$renames"/destination; then
+    pass=$((pass+1))
+else
+    echo -e "$red""[!]$reset DIRECTORY WAS NOT PATCHED SUCCESSFULLY: -r --renames $renames" >&2
+    fail=$((fail+1))
+    result=1
+fi
+
+rm -rf "$tmpname"
+
+echo -e "Failed $red$fail$reset tests."
+echo -e "Passed $green$pass$reset tests."
+
+exit "$result"
@@ -56,7 +56,7 @@ std::optional<ArgData> ArgParser::parse(Logger & logger) const noexcept {
             }
             try {
                 int Xarg = std::stoi(argv[++i]);
-                if (Xarg == 0 || Xarg >= 2) result.precision = Xarg;
+                if (Xarg == 0 || Xarg >= 2) result.diffOptions.precision = Xarg;
                 else logger.Log("Precision argument out of range {0} u <2; oo), ignoring.", Severity::Warning);
                 continue;
             } catch(const std::invalid_argument & excp) {
@@ -64,6 +64,84 @@ std::optional<ArgData> ArgParser::parse(Logger & logger) const noexcept {
                 continue;
             }
         }
+        if (currentArg == "-a" || currentArg == "--algorithm") {
+            if (i + 1 == argc) {
+                logger.Log("Found algorithm switch without an argument, ignoring.", Severity::Warning);
+                continue;
+            }
+            std::string Aarg (argv[++i]);
+            std::transform(Aarg.begin(), Aarg.end(), Aarg.begin(), ::tolower);
+            if (Aarg == "levenshtein") result.diffOptions.algorithm = DiffAlgorithm::Levenshtein;
+            else if (Aarg == "myers") result.diffOptions.algorithm = DiffAlgorithm::Myers;
+            else if (Aarg == "hirschberg") result.diffOptions.algorithm = DiffAlgorithm::Hirschberg;
+            else if (Aarg == "patience") result.diffOptions.algorithm = DiffAlgorithm::Patience;
+            else if (Aarg == "histogram") result.diffOptions.algorithm = DiffAlgorithm::Histogram;
+            else logger.Log("Argument of algorithm switch is unknown, ignoring.", Severity::Warning);
+            continue;
+        }
+        if (currentArg == "-j" || currentArg == "--jobs") {
+            if (i + 1 == argc) {
+                logger.Log("Found jobs switch without an argument, ignoring.", Severity::Warning);
+                continue;
+            }
+            try {
+                int Jarg = std::stoi(argv[++i]);
+                // More threads than a few per core only add overhead
+                const size_t maxJobs = 4 * ThreadPool::HardwareThreads();
+                if (Jarg < 0) logger.Log("Jobs argument out of range <0; oo), ignoring.", Severity::Warning);
+                else if ((size_t)Jarg > maxJobs) {
+                    logger.Log("Jobs argument too high, using " + std::to_string(maxJobs) + " instead.", Severity::Warning);
+                    result.diffOptions.jobs = maxJobs;
+                } else result.diffOptions.jobs = Jarg;
+                continue;
+            } catch(const std::invalid_argument & excp) {
+                logger.Log("Jobs argument was not a number, ignoring.", Severity::Warning);
+                continue;
+            } catch(const std::out_of_range & excp) {
+                logger.Log("Jobs argument was too large a number, ignoring.", Severity::Warning);
+                continue;
+            }
+        }
+        if (currentArg == "--split-anchors") {
+            result.diffOptions.splitAtAnchors = true;
+            continue;
+        }
+        if (currentArg == "--delta") {
+            result.binaryDelta = true;
+            continue;
+        }
+        if (currentArg == "--apply") {
+            result.applyDelta = true;
+            continue;
+        }
+        if (currentArg == "--chunked") {
+            result.diffOptions.contentDefinedChunks = true;
+            continue;
+        }
+        if (currentArg == "-r" || currentArg == "--recursive") {
+            result.diffOptions.recursive = true;
+            continue;
+        }
+        if (currentArg == "--renames") {
+            result.diffOptions.detectRenames = true;
+            continue;
+        }
+        if (currentArg == "--hash-cache") {
+            if (i + 1 == argc) {
+                logger.Log("Found hash cache switch without an argument, ignoring.", Severity::Warning);
+                continue;
+            }
+            result.diffOptions.hashCache = argv[++i];
+            continue;
+        }
+        if (currentArg == "--verify-hashes") {
+            result.diffOptions.verifyHashes = true;
+            continue;
+        }
+        if (currentArg == "--check-optimality") {
+            result.diffOptions.checkOptimality = true;
+            continue;
+        }
         if (currentArg == "-h" || currentArg == "--help") {
             result.showUsage = true;
             return result;
@@ -121,6 +199,11 @@ std::optional<ArgData> ArgParser::parse(Logger & logger) const noexcept {
     result.firstFilename = filenames[0];
     result.secondFilename = filenames[1];
 
+    if (result.binaryDelta && result.applyDelta) {
+        logger.Log("Cannot write and apply binary delta at once. Aborting.", Severity::Critical);
+        return {};
+    }
+
     if (result.firstFilename == "-") result.firstFilename = "/dev/stdin";
     if (result.secondFilename == "-") result.secondFilename = "/dev/stdin";
     if (result.firstFilename == result.secondFilename && result.firstFilename == "/dev/stdin") {
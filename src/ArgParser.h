@@ -62,7 +62,12 @@ struct ArgData {
     /// Forced output format, either human or compute readable.
     /// Might not be specified.
     std::optional<ForcedOutputStyle> forcedOutputStyle;
-    std::optional<size_t> precision = {};
+    /// Diffing settings, such as precision or algorithm used.
+    DiffOptions diffOptions;
     /// Logging verbosity specified by user
     int verbosity = 0;
+    /// Write compact binary delta from the first file to the second one, instead of the difference
+    bool binaryDelta = false;
+    /// Apply binary delta (the second file) to the first file, and write the result
+    bool applyDelta = false;
 };
@@ -2,62 +2,65 @@
 
 void DataDifference::Normalize() {
     // Merge subsequent deltas
-    std::list<DataDelta> newDeltas;
+    std::vector<DataDelta> oldDeltas = std::move(deltas);
+    deltas.clear();
+    deltas.reserve(oldDeltas.size());
 
-    for (const auto &delta : deltas) {
-        if (newDeltas.empty()) {
-            newDeltas.push_back(delta);
-            continue;
-        }
-
-        // Check, if it has the same type which is not modification and is right behind previous delta
-        if (delta.kind != DataDeltaKind::Modification && delta.kind == newDeltas.back().kind &&
-            newDeltas.back().indicatorSource + newDeltas.back().indicatorSourceLen == delta.indicatorSource) {
+    for (auto &delta : oldDeltas) {
+        if (!deltas.empty() && deltas.back().IsFollowedBy(delta.kind, delta.indicatorSource)) {
             // Merge the deltas
-            newDeltas.back().indicatorSourceLen += delta.indicatorSourceLen;
-            newDeltas.back().indicatorDestLen += delta.indicatorDestLen;
+            deltas.back().indicatorSourceLen += delta.indicatorSourceLen;
+            deltas.back().indicatorDestLen += delta.indicatorDestLen;
             // Merge context - keep only beginning and ending context of the old and new delta.
-            newDeltas.back().sourceFileContext.mergeWithNewContext(delta.sourceFileContext);
-            // Copy the change itself
-            std::copy(delta.deltaInfo.begin(), delta.deltaInfo.end(), back_inserter(newDeltas.back().deltaInfo));
+            deltas.back().sourceFileContext.mergeWithNewContext(delta.sourceFileContext);
+            // Move the change itself
+            std::move(delta.deltaInfo.begin(), delta.deltaInfo.end(), back_inserter(deltas.back().deltaInfo));
         } else {
-            newDeltas.push_back(delta);
+            deltas.push_back(std::move(delta));
         }
     }
-
-    deltas = newDeltas;
 }
 
 DataDifference::DataDifference(std::string sourceName, std::string destinationName,
-                               std::list<DataDelta> deltas, ForcedOutput forcedOutputStyle) :
+                               std::vector<DataDelta> deltas, ForcedOutput forcedOutputStyle,
+                               std::function<std::string_view(size_t idx)> sourceChunk,
+                               std::function<std::string_view(size_t idx)> destinationChunk) :
         sourceName(std::move(sourceName)), destinationName(std::move(destinationName)), deltas(std::move(deltas)),
-        forcedOutputStyle(forcedOutputStyle) {}
+        forcedOutputStyle(forcedOutputStyle), sourceChunk(std::move(sourceChunk)), destinationChunk(std::move(destinationChunk)) {}
 
-std::ostream &operator<<(std::ostream &stream, const DataDeltaKind &delta) {
+std::string_view deltaKindName(const DataDeltaKind &delta) {
     switch (delta) {
         case Addition:
-            stream << std::string("Addition");
-            return stream;
+            return "Addition";
         case Deletion:
-            stream << std::string("Deletion");
-            return stream;
+            return "Deletion";
         case Modification:
-            stream << std::string("Modification");
-            return stream;
+            return "Modification";
         default:
-            throw std::logic_error("Missing delta case: << operator");
+            throw std::logic_error("Missing delta case: delta kind name");
     }
 }
 
-DataContext &DataContext::mergeWithNewContext(const DataContext &rhs) {
-    // Throw away old after-context
-    std::vector<std::string> newContext = Utility::vectorSlice(rawData, 0, maxIdxOfOnContext);
-    // Copy new on- and after- context
-    std::copy(rhs.rawData.begin() + rhs.maxIdxOfOnContext - 1, rhs.rawData.end(), back_inserter(newContext));
+std::ostream &operator<<(std::ostream &stream, const DataDeltaKind &delta) {
+    stream << deltaKindName(delta);
+    return stream;
+}
 
-    maxIdxOfOnContext = maxIdxOfBeforeContext + (maxIdxOfOnContext - maxIdxOfBeforeContext) // context offset from this
-                        + (rhs.maxIdxOfOnContext - rhs.maxIdxOfBeforeContext); // context offset from rhs
-    rawData = newContext;
+DataContext::DataContext(size_t offset, size_t chunkCount, size_t beforeLen, size_t afterLen) {
+    if (offset >= chunkCount) {
+        beforeFrom = changedFrom = changedTo = afterTo = chunkCount;
+        return;
+    }
+    beforeFrom = offset < beforeLen ? 0 : offset - beforeLen;
+    changedFrom = offset;
+    changedTo = offset + 1; // Assume one chunk changed
+    afterTo = std::max(changedTo, std::min(offset + afterLen, chunkCount));
+}
+
+DataContext &DataContext::mergeWithNewContext(const DataContext &rhs) {
+    // Keep old before-context, take new on- and after- context
+    changedTo = rhs.changedTo;
+    afterTo = rhs.afterTo;
     return *this;
 }
 
@@ -69,3 +72,15 @@ DataDelta::DataDelta(DataDeltaKind kind, std::vector<std::string> deltaInfo,
                                                                            indicatorDestination(indicatorDestination),
                                                                            indicatorSourceLen(indicatorSourceLen),
                                                                            indicatorDestLen(indicatorDestLen) {}
+
+size_t DataDelta::ChunkCount() const {
+    if (!deltaInfo.empty()) return deltaInfo.size();
+    return kind == Deletion ? indicatorSourceLen : indicatorDestLen;
+}
+
+std::string_view DataDelta::Chunk(const DataDifference & difference, size_t idx) const {
+    if (!deltaInfo.empty()) return deltaInfo[idx];
+    // Indicators are 1-based
+    if (kind == Deletion) return difference.sourceChunk(indicatorSource - 1 + idx);
+    return difference.destinationChunk(indicatorDestination - 1 + idx);
+}
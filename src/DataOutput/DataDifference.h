@@ -1,8 +1,9 @@
 #pragma once
 
 #include <string>
+#include <string_view>
+#include <functional>
 #include <vector>
-#include <list>
 #include <stdexcept>
 
 #include "../Utility.cpp"
@@ -25,6 +26,12 @@ enum ForcedOutput {
     DirectPrint,
 };
 
+/// Return name of the delta kind (addition/deletion/modification), that is, it's enum name.
+///
+/// \param delta Delta kind
+/// \return Enum name of delta kind
+std::string_view deltaKindName(const DataDeltaKind & delta);
+
 /// Write the delta kind (addition/deletion/modification) to target stream,
 /// in string format (that is, it's enum name).
 ///
@@ -35,19 +42,26 @@ std::ostream & operator<<(std::ostream & stream, const DataDeltaKind & delta);
 
 /// Context of modification (see DataDeltaKind).
 ///
-/// Stores raw context data (that is, usually lines of
-/// source file), and two indexes, describing which ranges
-/// of the data correspond to what.
+/// Stores only ranges of chunk indexes of source file (usually lines), describing
+/// which chunks correspond to what. The chunks themselves are materialized
+/// only when the difference is written, see DataDifference::sourceChunk.
 struct DataContext {
-    /// Raw context data, in terms of lines of chunks
-    std::vector<std::string> rawData;
-    /// Maximum index of before-modification-context.
-    /// Thus, before-modification context has index <0; maxIdxOfBeforeContext).
-    size_t maxIdxOfBeforeContext;
-    /// Maximum index of on-modification context.
-    /// Thus, on-modification context has index <maxIdxOfBeforeContext; maxIdxOfOnContext).
-    /// The rest of it is after-modification context.
-    size_t maxIdxOfOnContext;
+    /// Before-modification context has chunk indexes <beforeFrom; changedFrom).
+    size_t beforeFrom = 0;
+    /// On-modification context has chunk indexes <changedFrom; changedTo).
+    size_t changedFrom = 0;
+    size_t changedTo = 0;
+    /// After-modification context has chunk indexes <changedTo; afterTo).
+    size_t afterTo = 0;
+
+    DataContext() = default;
+    /// Context of one changed chunk.
+    ///
+    /// \param offset Index of the changed chunk. If it is not within the source, the context is empty.
+    /// \param chunkCount Count of chunks of source file.
+    /// \param beforeLen Maximum count of chunks before the changed one.
+    /// \param afterLen Maximum count of chunks since the changed one, including it.
+    DataContext(size_t offset, size_t chunkCount, size_t beforeLen, size_t afterLen);
 
     /// Merge current context with next one. Ignore modifications,
     /// but merge adjacent additions and deletions, and merge them into
@@ -58,13 +72,16 @@ struct DataContext {
     DataContext & mergeWithNewContext(const DataContext & rhs);
 };
 
+struct DataDifference;
+
 /// One chunk change
 struct DataDelta {
     DataDelta(DataDeltaKind kind, std::vector<std::string> deltaInfo, DataContext sourceFileContext,
               size_t indicatorSource, size_t indicatorDestination, size_t indicatorSourceLen, size_t indicatorDestLen);
 
     DataDeltaKind kind;
-    /// This contains change information about the delta, most often the diff itself.
+    /// Change information, that is not made of chunks of the files, such as listing of directories.
+    /// Empty for hunks of chunks, whose changed chunks are viewed through the difference, see [Chunk].
     std::vector<std::string> deltaInfo;
     /// This contains context from the source file.
     DataContext sourceFileContext;
@@ -76,6 +93,23 @@ struct DataDelta {
     size_t indicatorSourceLen;
     /// Length of change in destination file
     size_t indicatorDestLen;
+
+    /// Count of changed chunks (or entries of deltaInfo), see [Chunk].
+    size_t ChunkCount() const;
+
+    /// View of one changed chunk: source chunk of a deletion, destination chunk of an addition or modification.
+    /// Views are created only when the delta is written, so hunks do not copy the chunks.
+    ///
+    /// \param difference The difference this delta belongs to
+    /// \param idx Index of the changed chunk within the delta, below [ChunkCount]
+    /// \return The chunk, as presented to user. Valid as long as the differ that produced the difference exists.
+    std::string_view Chunk(const DataDifference & difference, size_t idx) const;
+
+    /// Whether change of given kind, starting at given line (or byte) of the source file,
+    /// directly follows this delta, and both can be merged into one hunk.
+    bool IsFollowedBy(DataDeltaKind nextKind, size_t nextIndicatorSource) const {
+        return kind == nextKind && indicatorSource + indicatorSourceLen == nextIndicatorSource;
+    }
 };
 
 /// Collection of chunk changes,
@@ -86,16 +120,27 @@ struct DataDifference {
     std::string sourceName;
     /// Destination filename
     std::string destinationName;
-    /// List of chunk changes
-    std::list<DataDelta> deltas;
+    /// Chunk changes, in order of the source file. Adjacent changes of the same kind form one delta (hunk).
+    std::vector<DataDelta> deltas;
     /// If specific output style should be used,
     /// it will be recorded with this enum.
     ForcedOutput forcedOutputStyle;
+    /// Function that, given index of chunk of source file, returns its user-presentable view.
+    /// Used to materialize context of deltas. The view is valid as long as the differ that
+    /// produced this difference exists.
+    std::function<std::string_view(size_t idx)> sourceChunk;
+    /// The same as [sourceChunk], for chunks of destination file. Used to materialize added and modified chunks.
+    std::function<std::string_view(size_t idx)> destinationChunk;
+    /// Name the missing file (/dev/null) of an added or deleted file would have, if it existed.
+    /// Empty, if not known. Used in git extended header, which names both files.
+    std::string missingName;
 
     DataDifference(std::string sourceName, std::string destinationName,
-                   std::list<DataDelta> deltas, ForcedOutput forcedOutputStyle);
+                   std::vector<DataDelta> deltas, ForcedOutput forcedOutputStyle,
+                   std::function<std::string_view(size_t idx)> sourceChunk = {},
+                   std::function<std::string_view(size_t idx)> destinationChunk = {});
 
-/// Normalize data difference - that is, merge adjacent
-    /// additions, deletions and replacements.
+    /// Normalize data difference - that is, merge adjacent
+    /// additions, deletions and replacements. Deltas built by HunkBuilder are normalized already.
     void Normalize();
 };
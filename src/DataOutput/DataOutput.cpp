@@ -3,11 +3,11 @@
 #include "GraphicalOutput.h"
 #include "DirectOutput.h"
 
-DataOutput::DataOutput(Logger &logger) : logger(logger) { }
+DataOutput::DataOutput(Logger &logger) : logger(logger), out(STDOUT_FILENO) { }
 
-std::unique_ptr<DataOutput> DataOutput::GetOutput(const ArgData & data, const DataDifference & difference, Logger & logger) {
+std::unique_ptr<DataOutput> DataOutput::GetOutput(const ArgData & data, ForcedOutput forcedOutputStyle, Logger & logger) {
     // If file type requires direct output, use it, no matter what user said
-    if (difference.forcedOutputStyle == ForcedOutput::DirectPrint)
+    if (forcedOutputStyle == ForcedOutput::DirectPrint)
         return std::make_unique<DirectOutput>(logger);
 
     // Some output style was specifically forced, use it, no questions asked.
@@ -31,3 +31,14 @@ std::unique_ptr<DataOutput> DataOutput::GetOutput(const ArgData & data, const Da
     // Use graphical output.
     return std::make_unique<GraphicalOutput>(logger);
 }
+
+bool DataOutput::Write(const DataDifference & difference) {
+    Begin(difference);
+    for (const auto & delta : difference.deltas) Delta(difference, delta);
+    End(difference);
+    return Good();
+}
+
+bool DataOutput::Good() const {
+    return out.Good();
+}
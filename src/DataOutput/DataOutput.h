@@ -8,31 +8,41 @@
 #include <fstream>
 
 #include "DataDifference.h"
+#include "DeltaSink.h"
+#include "OutputBuffer.h"
 #include "../ArgParser.h"
 #include "../Logger/Logger.h"
 #include "../Utility.cpp"
 
-/// Generic class that displays set of differences between files
-class DataOutput {
+/// Generic class that displays set of differences between files.
+/// Hunks are written as soon as the differ passes them, see DeltaSink.
+class DataOutput : public DeltaSink {
 protected:
     Logger & logger;
+    /// Standard output. Everything is written at the end of the difference, or line by line to terminal.
+    OutputBuffer out;
     explicit DataOutput(Logger & logger);
 
 public:
     virtual ~DataOutput() = default;
 
     /// Considering user settings (argument data), environment context (such as output type), and settings by
-    /// differ that generated the difference, choose, create and return an instance of one chosen DataOutput subclass.
+    /// differ that generates the difference, choose, create and return an instance of one chosen DataOutput subclass.
     ///
     /// \param data Argument data
-    /// \param difference Set of differences from source to destination file
+    /// \param forcedOutputStyle Output style required by the differ, see FileDiffer::OutputStyle.
     /// \param logger Logger
     /// \return Unique pointer to instance of a DataOutput subclass
-    static std::unique_ptr<DataOutput> GetOutput(const ArgData & data, const DataDifference & difference, Logger & logger);
+    static std::unique_ptr<DataOutput> GetOutput(const ArgData & data, ForcedOutput forcedOutputStyle, Logger & logger);
 
-    /// Print data difference to an output channel. Specific output channel is set up upon instantination of the class.
+    /// Print whole, already computed data difference to an output channel.
+    /// Specific output channel is set up upon instantination of the class.
     ///
     /// \param difference Set of differences from source to destination file
     /// \return Whether the write to target file was successful.
-    virtual bool Write(const DataDifference & difference) = 0;
+    bool Write(const DataDifference & difference);
+
+    /// Whether everything written so far was written to target file successfully.
+    /// Call after the end of the difference, when the output is flushed.
+    bool Good() const;
 };
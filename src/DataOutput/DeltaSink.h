@@ -0,0 +1,90 @@
+#pragma once
+
+#include <chrono>
+#include <optional>
+#include <vector>
+
+#include "DataDifference.h"
+
+/// Receives difference between two files hunk by hunk, as soon as the differ knows the hunk is final.
+///
+/// Deltas passed to the sink are not stored in the difference, so memory used by the difference
+/// stays bounded no matter how many hunks there are, and the first hunk can be written
+/// before the rest of the files is diffed.
+class DeltaSink {
+public:
+    virtual ~DeltaSink() = default;
+
+    /// Start of the difference. Called once, before any delta.
+    ///
+    /// \param difference Names of the files, output style and source chunks. Deltas are not part of it.
+    virtual void Begin(const DataDifference & difference) = 0;
+    /// One hunk of the difference. Hunks are passed in order of the source file.
+    ///
+    /// \param difference The same difference, that was passed to [Begin].
+    /// \param delta The hunk
+    virtual void Delta(const DataDifference & difference, const DataDelta & delta) = 0;
+    /// End of the difference. Called once, after all deltas.
+    ///
+    /// \param difference The same difference, that was passed to [Begin].
+    virtual void End(const DataDifference & difference) = 0;
+};
+
+/// Passes the difference to another sink, and measures time to the first hunk and to the end of the difference,
+/// since construction of this sink.
+class TimedDeltaSink : public DeltaSink {
+    typedef std::chrono::steady_clock clock;
+
+    DeltaSink & target;
+    clock::time_point start = clock::now();
+    std::optional<clock::duration> firstDelta, end;
+
+public:
+    explicit TimedDeltaSink(DeltaSink & target) : target(target) { }
+
+    void Begin(const DataDifference & difference) override { target.Begin(difference); }
+    void Delta(const DataDifference & difference, const DataDelta & delta) override {
+        target.Delta(difference, delta);
+        if (!firstDelta) firstDelta = clock::now() - start;
+    }
+    void End(const DataDifference & difference) override {
+        target.End(difference);
+        end = clock::now() - start;
+    }
+
+    /// Time until the first hunk was passed on, or nothing, if there was no hunk
+    std::optional<clock::duration> TimeToFirstDelta() const { return firstDelta; }
+    /// Time until the end of the difference, or nothing, if it did not end yet
+    std::optional<clock::duration> TimeToEnd() const { return end; }
+};
+
+/// Keeps the whole difference, so it can be found on one thread, and passed to the target sink
+/// later, from another one, in order with other differences.
+///
+/// Views of the chunks of the difference (see DataDifference::sourceChunk) have to stay valid until it is replayed.
+class RecordingDeltaSink : public DeltaSink {
+    std::optional<DataDifference> difference;
+    std::vector<DataDelta> deltas;
+    bool ended = false;
+
+public:
+    void Begin(const DataDifference & difference) override { this->difference = difference; }
+    void Delta(const DataDifference & difference, const DataDelta & delta) override { deltas.push_back(delta); }
+    void End(const DataDifference & difference) override { ended = true; }
+
+    /// Whether no hunk was recorded
+    bool Empty() const { return deltas.empty(); }
+
+    /// Recorded difference, which may be amended before it is replayed. Null, if none was begun.
+    DataDifference * Difference() { return difference ? &*difference : nullptr; }
+
+    /// Pass everything recorded so far to the target sink.
+    ///
+    /// \param target The sink
+    void Replay(DeltaSink & target) const {
+        if (!difference) return;
+        target.Begin(*difference);
+        for (const auto & delta : deltas) target.Delta(*difference, delta);
+        if (ended) target.End(*difference);
+    }
+};
@@ -2,11 +2,14 @@
 
 DirectOutput::DirectOutput(Logger &logger) : DataOutput(logger) { }
 
-bool DirectOutput::Write(const DataDifference &difference) {
-    for (const auto & delta : difference.deltas) {
-        for (const auto & line : delta.deltaInfo) {
-            std::cout << line;
-        }
+void DirectOutput::Begin(const DataDifference &difference) { }
+
+void DirectOutput::Delta(const DataDifference &difference, const DataDelta &delta) {
+    for (size_t c = 0; c < delta.ChunkCount(); c++) {
+        out << delta.Chunk(difference, c);
     }
-    return std::cout.good();
+}
+
+void DirectOutput::End(const DataDifference &difference) {
+    out.Flush();
 }
@@ -6,6 +6,8 @@
 class DirectOutput : public DataOutput {
 public:
     explicit DirectOutput(Logger & logger);
+    void Begin(const DataDifference & difference) override;
     /// Write changes directly to the stdout, ignore context and everything else.
-    bool Write(const DataDifference & difference) override;
+    void Delta(const DataDifference & difference, const DataDelta & delta) override;
+    void End(const DataDifference & difference) override;
 };
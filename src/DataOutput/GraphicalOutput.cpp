@@ -1,59 +1,64 @@
 #include "GraphicalOutput.h"
 
-bool GraphicalOutput::Write(const DataDifference &difference) {
+void GraphicalOutput::Begin(const DataDifference &difference) {
+    out << "Difference between files \"" << difference.sourceName << "\" -> \"" << difference.destinationName << "\":" << '\n';
+    anyDelta = false;
+}
+
+void GraphicalOutput::Delta(const DataDifference &difference, const DataDelta &delta) {
     using namespace Utility::Colors;
 
-    std::cout << "Difference between files \"" << difference.sourceName << "\" -> \"" << difference.destinationName << "\":" << std::endl;
-    if (difference.deltas.empty()) {
-        std::cout << "Files are identical." << std::endl;
-        return true;
-    }
-    for (const auto & delta : difference.deltas) {
-        std::cout << std::endl;
+    anyDelta = true;
+    out << '\n';
 
-        std::cout << ansi_gray_text << delta.kind << " at offset +" << delta.indicatorSource << ansi_reset << std::endl;
+    out << ansi_gray_text << deltaKindName(delta.kind) << " at offset +" << delta.indicatorSource << ansi_reset << '\n';
 
-        // Write before-change-context
-        for (size_t i = 0; i < delta.sourceFileContext.maxIdxOfBeforeContext; i++) {
-                if (i >= delta.sourceFileContext.rawData.size()) break;
-                std::cout << delta.sourceFileContext.rawData[i] << std::endl;
-        }
+    const DataContext & context = delta.sourceFileContext;
+    // Write before-change-context
+    for (size_t i = context.beforeFrom; i < context.changedFrom; i++) {
+        out.Reference(difference.sourceChunk(i)) << '\n';
+    }
 
-        switch(delta.kind) {
-            case Addition:
-                for (const auto & deltaInfo : delta.deltaInfo) {
-                    if (deltaInfo.empty()) std::cout << ansi_green << ansi_gray_text << "(empty line)" << ansi_reset << std::endl;
-                    else std::cout << ansi_green << deltaInfo << ansi_reset << std::endl;
-                }
-                break;
-            case Deletion:
-                for (const auto & deltaInfo : delta.deltaInfo) {
-                    if (deltaInfo.empty()) std::cout << ansi_red << ansi_gray_text << "(empty line)" << ansi_reset << std::endl;
-                    else std::cout << ansi_red << deltaInfo << ansi_reset << std::endl;
-                }
-                break;
-            case Modification: {
-                size_t k = delta.sourceFileContext.maxIdxOfBeforeContext;
-                for (const auto &deltaInfo : delta.deltaInfo) {
-                    if (k < delta.sourceFileContext.rawData.size())
-                        std::cout << ansi_red << delta.sourceFileContext.rawData[k] << ansi_reset << std::endl;
-                    std::cout << ansi_green << deltaInfo << ansi_reset << std::endl;
-                    k++;
+    switch(delta.kind) {
+        case Addition:
+            for (size_t c = 0; c < delta.ChunkCount(); c++) {
+                std::string_view chunk = delta.Chunk(difference, c);
+                if (chunk.empty()) out << ansi_green << ansi_gray_text << "(empty line)" << ansi_reset << '\n';
+                else out << ansi_green << chunk << ansi_reset << '\n';
+            }
+            break;
+        case Deletion:
+            for (size_t c = 0; c < delta.ChunkCount(); c++) {
+                std::string_view chunk = delta.Chunk(difference, c);
+                if (chunk.empty()) out << ansi_red << ansi_gray_text << "(empty line)" << ansi_reset << '\n';
+                else out << ansi_red << chunk << ansi_reset << '\n';
+            }
+            break;
+        case Modification: {
+            size_t k = context.changedFrom;
+            for (size_t c = 0; c < delta.ChunkCount(); c++) {
+                if (k < context.changedTo) {
+                    out << ansi_red;
+                    out.Reference(difference.sourceChunk(k)) << ansi_reset << '\n';
                 }
-                break;
+                out << ansi_green << delta.Chunk(difference, c) << ansi_reset << '\n';
+                k++;
             }
-            default:
-                throw std::logic_error("Missing delta case: graphical output");
+            break;
         }
+        default:
+            throw std::logic_error("Missing delta case: graphical output");
+    }
 
-        // Write after-change-context
-        for (size_t i = delta.sourceFileContext.maxIdxOfOnContext; i < delta.sourceFileContext.rawData.size(); i++) {
-            if (i >= delta.sourceFileContext.rawData.size()) break;
-            std::cout << delta.sourceFileContext.rawData[i] << std::endl;
-        }
+    // Write after-change-context
+    for (size_t i = context.changedTo; i < context.afterTo; i++) {
+        out.Reference(difference.sourceChunk(i)) << '\n';
     }
+}
 
-    return std::cout.good();
+void GraphicalOutput::End(const DataDifference &difference) {
+    if (!anyDelta) out << "Files are identical." << '\n';
+    out.Flush();
 }
 
 GraphicalOutput::GraphicalOutput(Logger &logger) : DataOutput(logger) { }
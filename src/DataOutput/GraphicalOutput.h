@@ -5,7 +5,12 @@
 
 /// Use this for user-friendly output. This uses 8-bit ANSI colors.
 class GraphicalOutput : public DataOutput {
+    /// Whether any delta was written since the beginning of the difference
+    bool anyDelta = false;
+
 public:
     explicit GraphicalOutput(Logger & logger);
-    bool Write(const DataDifference & difference) override;
+    void Begin(const DataDifference & difference) override;
+    void Delta(const DataDifference & difference, const DataDelta & delta) override;
+    void End(const DataDifference & difference) override;
 };
@@ -0,0 +1,24 @@
+#include "HunkBuilder.h"
+
+HunkBuilder::HunkBuilder(DeltaSink & sink, const DataDifference & difference) : sink(sink), difference(difference) { }
+
+void HunkBuilder::Append(DataDeltaKind kind, const DataContext & sourceFileContext,
+                         size_t indicatorSource, size_t indicatorDestination, size_t indicatorSourceLen,
+                         size_t indicatorDestLen) {
+    if (hunk && hunk->IsFollowedBy(kind, indicatorSource)) {
+        hunk->indicatorSourceLen += indicatorSourceLen;
+        hunk->indicatorDestLen += indicatorDestLen;
+        hunk->sourceFileContext.mergeWithNewContext(sourceFileContext);
+        return;
+    }
+    // The change does not extend the hunk, so the hunk is final
+    Finish();
+    hunk.emplace(kind, std::vector<std::string>{}, sourceFileContext,
+                 indicatorSource, indicatorDestination, indicatorSourceLen, indicatorDestLen);
+}
+
+void HunkBuilder::Finish() {
+    if (!hunk) return;
+    sink.Delta(difference, *hunk);
+    hunk.reset();
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <optional>
+
+#include "DataDifference.h"
+#include "DeltaSink.h"
+
+/// Merges changes of single chunks into hunks - runs of adjacent changes of the same kind -
+/// and passes each hunk to the sink as soon as the next change does not extend it.
+///
+/// Only the last hunk is kept in memory. Hunks hold ranges of changed chunks, not the chunks themselves,
+/// so building them allocates nothing per chunk (see DataDelta::Chunk).
+class HunkBuilder {
+    DeltaSink & sink;
+    const DataDifference & difference;
+    /// Last hunk, which might still be extended by the next change
+    std::optional<DataDelta> hunk;
+
+public:
+    /// \param sink Sink that receives finished hunks
+    /// \param difference Difference the hunks belong to, passed to the sink with each hunk
+    HunkBuilder(DeltaSink & sink, const DataDifference & difference);
+
+    /// Append change of one chunk. Parameters are the same as of DataDelta.
+    ///
+    /// \param kind Delta kind
+    /// \param sourceFileContext Context of the chunk in the source file.
+    /// \param indicatorSource Line (or byte) of the source file, that is affected by this change.
+    /// \param indicatorDestination Line (or byte) of the destination file, that is affected by this change.
+    /// \param indicatorSourceLen Length of change in source file
+    /// \param indicatorDestLen Length of change in destination file
+    void Append(DataDeltaKind kind, const DataContext & sourceFileContext,
+                size_t indicatorSource, size_t indicatorDestination, size_t indicatorSourceLen, size_t indicatorDestLen);
+
+    /// Pass the last hunk to the sink. Has to be called after the last change was appended.
+    void Finish();
+};
@@ -0,0 +1,79 @@
+#include "OutputBuffer.h"
+
+#include <cerrno>
+#include <charconv>
+#include <cstring>
+#include <unistd.h>
+
+OutputBuffer::OutputBuffer(int fd) : fd(fd), terminal(isatty(fd)), buffer(std::make_unique<char[]>(bufferSize)) {
+    fragments.reserve(maxFragments);
+}
+
+OutputBuffer::~OutputBuffer() {
+    Flush();
+}
+
+OutputBuffer & OutputBuffer::operator<<(std::string_view text) {
+    if (text.empty()) return *this;
+    if (text.size() > bufferSize - used || fragments.size() == maxFragments) Flush();
+    if (text.size() > bufferSize) {
+        // Does not fit into the buffer at all, write it right away
+        addFragment(text.data(), text.size());
+        Flush();
+        return *this;
+    }
+    char * target = buffer.get() + used;
+    std::memcpy(target, text.data(), text.size());
+    used += text.size();
+    addFragment(target, text.size());
+    return *this;
+}
+
+OutputBuffer & OutputBuffer::operator<<(char character) {
+    *this << std::string_view(&character, 1);
+    if (character == '\n' && terminal) Flush();
+    return *this;
+}
+
+OutputBuffer & OutputBuffer::operator<<(size_t number) {
+    char digits[24];
+    auto result = std::to_chars(digits, digits + sizeof(digits), number);
+    return *this << std::string_view(digits, result.ptr - digits);
+}
+
+OutputBuffer & OutputBuffer::Reference(std::string_view text) {
+    if (text.size() < referenceLimit) return *this << text;
+    if (fragments.size() == maxFragments) Flush();
+    addFragment(text.data(), text.size());
+    return *this;
+}
+
+bool OutputBuffer::Flush() {
+    size_t first = 0;
+    while (good && first < fragments.size()) {
+        ssize_t written = writev(fd, fragments.data() + first, (int)(fragments.size() - first));
+        if (written < 0 && errno == EINTR) continue;
+        if (written <= 0) {
+            good = false;
+            break;
+        }
+        // Skip fragments written completely, and written part of the next one
+        size_t rest = written;
+        while (first < fragments.size() && rest >= fragments[first].iov_len) rest -= fragments[first++].iov_len;
+        if (rest != 0) {
+            fragments[first].iov_base = (char *)fragments[first].iov_base + rest;
+            fragments[first].iov_len -= rest;
+        }
+    }
+    fragments.clear();
+    used = 0;
+    return good;
+}
+
+void OutputBuffer::addFragment(const char * data, size_t size) {
+    if (!fragments.empty() && (const char *)fragments.back().iov_base + fragments.back().iov_len == data) {
+        fragments.back().iov_len += size;
+        return;
+    }
+    fragments.push_back({(void *)data, size});
+}
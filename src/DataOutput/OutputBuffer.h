@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string_view>
+#include <vector>
+#include <sys/uio.h>
+
+/// Buffered writer into a file descriptor, used by DataOutput classes instead of std::cout.
+///
+/// Short fragments of text are copied into one large buffer, long fragments that stay valid
+/// are only referenced. All of them are written by a single writev call, once the buffer
+/// or the list of fragments is full, and at explicit Flush. Output to a terminal is flushed
+/// at the end of each line instead, so the user sees it as soon as it is written.
+class OutputBuffer {
+    /// Size of the buffer of copied fragments
+    static constexpr size_t bufferSize = 1 << 20;
+    /// Fragments passed to [Reference] shorter than this are copied anyway
+    static constexpr size_t referenceLimit = 256;
+    /// Maximum count of fragments written by one writev call (IOV_MAX on Linux)
+    static constexpr size_t maxFragments = 1024;
+
+    int fd;
+    bool terminal;
+    std::unique_ptr<char[]> buffer;
+    /// Count of bytes of the buffer in use
+    size_t used = 0;
+    /// Fragments waiting to be written, pointing either to the buffer or to referenced text
+    std::vector<iovec> fragments;
+    bool good = true;
+
+public:
+    /// \param fd File descriptor, that is written to. It is not closed by this class.
+    explicit OutputBuffer(int fd);
+    /// Flushes everything written so far
+    ~OutputBuffer();
+    OutputBuffer(const OutputBuffer &) = delete;
+    OutputBuffer & operator=(const OutputBuffer &) = delete;
+
+    /// Append copy of the text
+    OutputBuffer & operator<<(std::string_view text);
+    /// Append one character. Flushes at the end of line, if writing to terminal.
+    OutputBuffer & operator<<(char character);
+    /// Append decimal representation of the number
+    OutputBuffer & operator<<(size_t number);
+    /// Append text without copying it. The text has to stay valid until the next [Flush].
+    OutputBuffer & Reference(std::string_view text);
+
+    /// Write everything appended so far.
+    ///
+    /// \return Whether everything written so far was written successfully.
+    bool Flush();
+    /// Whether everything flushed so far was written successfully.
+    bool Good() const { return good; }
+
+private:
+    /// Append fragment to the list of fragments, extending the last one if they are adjacent
+    void addFragment(const char * data, size_t size);
+};
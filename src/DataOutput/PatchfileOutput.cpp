@@ -1,3 +1,5 @@
+#include <filesystem>
+
 #include "PatchfileOutput.h"
 
 
@@ -14,6 +16,9 @@
 /// --- a/foo.c
 /// +++ b/foo.c
 /// , designating the names of files changed.
+/// Empty file, that was added or deleted, has no blocks, and is
+/// preceded by git extended header (`diff --git`, `new file mode`),
+/// as are all files after it.
 ///
 /// Afterwards, the file consists of one or more blocks.
 /// Each block starts with a @@ header.
@@ -33,40 +38,82 @@
 /// Source: https://www.oreilly.com/library/view/git-pocket-guide/9781449327507/ch11.html
 PatchfileOutput::PatchfileOutput(Logger &logger) : DataOutput(logger) { }
 
-bool PatchfileOutput::Write(const DataDifference &difference) {
-    // Write file header
-    std::cout << "--- " << difference.sourceName << std::endl;
-    std::cout << "+++ " << difference.destinationName << std::endl;
+void PatchfileOutput::Begin(const DataDifference &difference) {
+    headerWritten = false;
+}
 
-    for(const auto & delta : difference.deltas) {
-        // Write delta header
-        std::cout << "@@ -" << delta.indicatorSource << "," << delta.indicatorSourceLen << " +"
-                      << delta.indicatorDestination << "," << delta.indicatorDestLen << " @@" << std::endl;
-        switch(delta.kind) {
-            case Addition:
-                for (const auto & deltaInfo : delta.deltaInfo) {
-                    std::cout << "+" << deltaInfo << std::endl;
-                }
-                break;
-            case Deletion:
-                for (const auto & deltaInfo : delta.deltaInfo) {
-                    std::cout << "-" << deltaInfo << std::endl;
-                }
-                break;
-            case Modification: {
-                size_t k = delta.sourceFileContext.maxIdxOfBeforeContext;
-                for (const auto & deltaInfo : delta.deltaInfo) {
-                    if (k < delta.sourceFileContext.rawData.size())
-                        std::cout << "-" << delta.sourceFileContext.rawData[k] << std::endl;
-                    std::cout << "+" << deltaInfo << std::endl;
-                    k++;
+void PatchfileOutput::writeHeader(const DataDifference &difference) {
+    if (headerWritten) return;
+    if (gitHeaders) {
+        bool added = difference.sourceName == "/dev/null", deleted = difference.destinationName == "/dev/null";
+        // Missing file is named as it would be if it existed, or the same as the existing one, if that is not known
+        const std::string & missingName = !difference.missingName.empty() ? difference.missingName
+                                          : added ? difference.destinationName : difference.sourceName;
+        out << "diff --git " << (added ? missingName : difference.sourceName) << ' '
+            << (deleted ? missingName : difference.destinationName) << '\n';
+        if (added) {
+            out << "new file mode " << fileMode(difference.destinationName) << '\n';
+        } else if (deleted) {
+            out << "deleted file mode " << fileMode(difference.sourceName) << '\n';
+        } else if (fileMode(difference.sourceName) != fileMode(difference.destinationName)) {
+            out << "old mode " << fileMode(difference.sourceName) << '\n';
+            out << "new mode " << fileMode(difference.destinationName) << '\n';
+        }
+    }
+    out << "--- " << difference.sourceName << '\n';
+    out << "+++ " << difference.destinationName << '\n';
+    headerWritten = true;
+}
+
+std::string_view PatchfileOutput::fileMode(const std::string & name) {
+    std::error_code error;
+    auto permissions = std::filesystem::status(name, error).permissions();
+    if (!error && (permissions & std::filesystem::perms::owner_exec) != std::filesystem::perms::none) return "100755";
+    return "100644";
+}
+
+void PatchfileOutput::Delta(const DataDifference &difference, const DataDelta &delta) {
+    writeHeader(difference);
+    // Write delta header
+    out << "@@ -" << delta.indicatorSource << "," << delta.indicatorSourceLen << " +"
+        << delta.indicatorDestination << "," << delta.indicatorDestLen << " @@" << '\n';
+    switch(delta.kind) {
+        case Addition:
+            for (size_t c = 0; c < delta.ChunkCount(); c++) {
+                out << "+";
+                out.Reference(delta.Chunk(difference, c)) << '\n';
+            }
+            break;
+        case Deletion:
+            for (size_t c = 0; c < delta.ChunkCount(); c++) {
+                out << "-";
+                out.Reference(delta.Chunk(difference, c)) << '\n';
+            }
+            break;
+        case Modification: {
+            size_t k = delta.sourceFileContext.changedFrom;
+            for (size_t c = 0; c < delta.ChunkCount(); c++) {
+                if (k < delta.sourceFileContext.changedTo) {
+                    out << '-';
+                    out.Reference(difference.sourceChunk(k)) << '\n';
                 }
-                break;
+                out << "+";
+                out.Reference(delta.Chunk(difference, c)) << '\n';
+                k++;
             }
-            default:
-                throw std::logic_error("Missing delta case: patchfile output");
+            break;
         }
+        default:
+            throw std::logic_error("Missing delta case: patchfile output");
     }
+}
 
-    return std::cout.good();
+void PatchfileOutput::End(const DataDifference &difference) {
+    if (!headerWritten) {
+        // Empty file added or deleted has no hunks, `patch(1)` and `git apply` act on it by git extended header only.
+        // Such header lasts until the next one, so files after it get one too.
+        if (difference.sourceName == "/dev/null" || difference.destinationName == "/dev/null") gitHeaders = true;
+        writeHeader(difference);
+    }
+    out.Flush();
 }
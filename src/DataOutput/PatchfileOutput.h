@@ -1,10 +1,27 @@
 #pragma once
 
+#include <string_view>
+
 #include "DataOutput.h"
 
 /// Use this for machine-friendly output. Produces patchfile, that can be processed by the `patch(1)` utility.
 class PatchfileOutput : public DataOutput {
+    /// File header of the current difference is written before its first hunk, or at its end
+    bool headerWritten = false;
+    /// Precede file headers by git extended headers, since an empty file was added or deleted
+    bool gitHeaders = false;
+
+    /// Write `---`/`+++` lines with names of the files, unless already written.
+    void writeHeader(const DataDifference & difference);
+
+    /// Git mode of the file: 100755 if it is executable by its owner, 100644 otherwise.
+    ///
+    /// \param name Path of the file
+    static std::string_view fileMode(const std::string & name);
+
 public:
     explicit PatchfileOutput(Logger & logger);
-    bool Write(const DataDifference & difference) override;
+    void Begin(const DataDifference & difference) override;
+    void Delta(const DataDifference & difference, const DataDelta & delta) override;
+    void End(const DataDifference & difference) override;
 };
@@ -1,13 +1,18 @@
 #include "Diffeek.h"
+#include "FileDiffer/BinaryFileDiffer.h"
+#include "FileDiffer/Algorithms/BinaryDelta.h"
 
 Diffeek::Diffeek(const ArgData & argumentData, Logger & logger) {
-    // First of all, load file loaders
-    if (argumentData.dataFormat != Automatic) {
-        fileLoaderFrom = FileDiffer::GetInstance(argumentData.dataFormat, argumentData.firstFilename, argumentData.dataLoadMode, argumentData.precision, logger);
-        fileLoaderTo = FileDiffer::GetInstance(argumentData.dataFormat, argumentData.secondFilename, argumentData.dataLoadMode, argumentData.precision, logger);
+    // First of all, load file loaders. Binary delta works with bytes of any file.
+    if (argumentData.binaryDelta || argumentData.applyDelta) {
+        fileLoaderFrom = FileDiffer::GetInstance(DataFormat::Binary, argumentData.firstFilename, argumentData.dataLoadMode, argumentData.diffOptions, logger);
+        fileLoaderTo = FileDiffer::GetInstance(DataFormat::Binary, argumentData.secondFilename, argumentData.dataLoadMode, argumentData.diffOptions, logger);
+    } else if (argumentData.dataFormat != Automatic) {
+        fileLoaderFrom = FileDiffer::GetInstance(argumentData.dataFormat, argumentData.firstFilename, argumentData.dataLoadMode, argumentData.diffOptions, logger);
+        fileLoaderTo = FileDiffer::GetInstance(argumentData.dataFormat, argumentData.secondFilename, argumentData.dataLoadMode, argumentData.diffOptions, logger);
     } else {
-        fileLoaderFrom = FileDiffer::GetInstance(argumentData.firstFilename, argumentData.dataLoadMode, argumentData.precision, logger);
-        fileLoaderTo = FileDiffer::GetInstance(argumentData.secondFilename, argumentData.dataLoadMode, argumentData.precision, logger);
+        fileLoaderFrom = FileDiffer::GetInstance(argumentData.firstFilename, argumentData.dataLoadMode, argumentData.diffOptions, logger);
+        fileLoaderTo = FileDiffer::GetInstance(argumentData.secondFilename, argumentData.dataLoadMode, argumentData.diffOptions, logger);
     }
 
     loadMode = argumentData.dataLoadMode;
@@ -20,10 +25,47 @@ bool Diffeek::LoadData(Logger & logger) {
     return true;
 }
 
-std::optional<DataDifference> Diffeek::Diff() const {
-    auto result = fileLoaderFrom->Diff(*fileLoaderTo);
-    if (result.has_value()) {
-        result->Normalize();
+bool Diffeek::Diff(DeltaSink & sink, Logger & logger) const {
+    TimedDeltaSink timedSink(sink);
+    if (!fileLoaderFrom->Diff(*fileLoaderTo, timedSink)) return false;
+
+    auto milliseconds = [](std::chrono::steady_clock::duration duration) {
+        return std::to_string(std::chrono::duration_cast<std::chrono::milliseconds>(duration).count()) + " ms";
+    };
+    if (timedSink.TimeToFirstDelta().has_value())
+        logger.Log("First hunk written after " + milliseconds(*timedSink.TimeToFirstDelta()) + ".", Severity::Info);
+    if (timedSink.TimeToEnd().has_value())
+        logger.Log("Difference written after " + milliseconds(*timedSink.TimeToEnd()) + ".", Severity::Info);
+    return true;
+}
+
+ForcedOutput Diffeek::OutputStyle() const {
+    return fileLoaderFrom->OutputStyle();
+}
+
+bool Diffeek::WriteDelta(OutputBuffer & out, Logger & logger) const {
+    const auto & source = dynamic_cast<const BinaryFileDiffer &>(*fileLoaderFrom).Bytes();
+    const auto & target = dynamic_cast<const BinaryFileDiffer &>(*fileLoaderTo).Bytes();
+
+    BinaryDelta::Summary summary = BinaryDelta::Write(source, target, out);
+    logger.Log("Binary delta of " + std::to_string(summary.deltaBytes) + " bytes copies " + std::to_string(summary.copiedBytes)
+               + " bytes by " + std::to_string(summary.copies) + " instruction(s), and inserts " + std::to_string(summary.insertedBytes)
+               + " bytes by " + std::to_string(summary.inserts) + " instruction(s).", Severity::Info);
+    return true;
+}
+
+bool Diffeek::ApplyDelta(OutputBuffer & out, Logger & logger) const {
+    const auto & source = dynamic_cast<const BinaryFileDiffer &>(*fileLoaderFrom).Bytes();
+    const auto & delta = dynamic_cast<const BinaryFileDiffer &>(*fileLoaderTo).Bytes();
+
+    std::string error;
+    std::optional<std::vector<char>> target = BinaryDelta::Apply(source, delta, error);
+    if (!target) {
+        logger.Log("Cannot apply binary delta: " + error + ".", Severity::Critical);
+        return false;
     }
-    return result;
+    // Target is referenced, so it has to be written before it goes out of scope. Failure is reported by the output.
+    out.Reference(std::string_view(target->data(), target->size()));
+    out.Flush();
+    return true;
 }
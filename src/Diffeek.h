@@ -5,6 +5,8 @@
 
 #include "FileDiffer/FileDiffer.h"
 #include "DataOutput/DataDifference.h"
+#include "DataOutput/DeltaSink.h"
+#include "DataOutput/OutputBuffer.h"
 #include "ArgParser.h"
 
 /// The diffing application.
@@ -28,11 +30,28 @@ public:
     /// \returns A boolean value indicating success. Details
     /// about the run will be logged into logger instance.
     bool LoadData(Logger & logger);
-    /// Diff loaded files, as passed in constructor's ArgData.
+    /// Diff loaded files, as passed in constructor's ArgData,
+    /// and pass the difference to the sink, hunk by hunk.
     ///
-    /// \returns A structure with details about the diff result.
-    /// The result might be empty, if diffing failed. Details
+    /// \param sink Sink that receives details about the diff result.
+    /// \param logger Structure used to log events during runtime. Time to the first
+    /// hunk and to the end of the difference is logged as info.
+    /// \returns A boolean value indicating success. Details
     /// about the operation will be logged into the logger instance,
     /// that was passed in the constructor.
-    std::optional<DataDifference> Diff() const;
+    bool Diff(DeltaSink & sink, Logger & logger) const;
+    /// Write compact binary delta from the first file to the second one, see BinaryDelta.
+    ///
+    /// \param out Output the delta is written to
+    /// \param logger Structure used to log events during runtime. Size of the delta is logged as info.
+    /// \returns A boolean value indicating success.
+    bool WriteDelta(OutputBuffer & out, Logger & logger) const;
+    /// Apply binary delta (the second file) to the first file, and write the result, see BinaryDelta.
+    ///
+    /// \param out Output the patched file is written to
+    /// \param logger Structure used to log events during runtime
+    /// \returns A boolean value indicating success. Nothing is written, if the delta cannot be applied.
+    bool ApplyDelta(OutputBuffer & out, Logger & logger) const;
+    /// Output style required by format of loaded files, see DataOutput::GetOutput.
+    ForcedOutput OutputStyle() const;
 };
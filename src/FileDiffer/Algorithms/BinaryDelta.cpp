@@ -0,0 +1,175 @@
+#include "BinaryDelta.h"
+
+#include <cstring>
+#include <string_view>
+#include <algorithm>
+#include <tuple>
+
+#include "SuffixArray.h"
+#include "../../Utility.cpp"
+
+namespace {
+    const char magic[4] = {'D', 'F', 'K', 'D'};
+
+    /// Append number as unsigned LEB128 varint
+    void appendVarint(std::string & output, uint64_t value) {
+        while (value >= 0x80) {
+            output.push_back((char)(value | 0x80));
+            value >>= 7;
+        }
+        output.push_back((char)value);
+    }
+
+    /// Reader of the delta, that fails on reading past its end
+    struct DeltaReader {
+        const std::vector<char> & delta;
+        size_t position = 0;
+        bool good = true;
+
+        uint64_t varint() {
+            uint64_t value = 0;
+            for (unsigned shift = 0; shift < 64; shift += 7) {
+                if (position >= delta.size()) break;
+                auto byte = (unsigned char)delta[position++];
+                value |= (uint64_t)(byte & 0x7f) << shift;
+                if (!(byte & 0x80)) return value;
+            }
+            good = false;
+            return 0;
+        }
+
+        const char * bytes(size_t count) {
+            if (delta.size() - position < count) {
+                good = false;
+                return nullptr;
+            }
+            position += count;
+            return delta.data() + position - count;
+        }
+    };
+
+    /// Count of bytes both ranges start with
+    size_t commonLength(const char * lhs, size_t lhsLength, const char * rhs, size_t rhsLength) {
+        size_t length = std::min(lhsLength, rhsLength), i = 0;
+        while (i < length && lhs[i] == rhs[i]) i++;
+        return i;
+    }
+}
+
+BinaryDelta::Summary BinaryDelta::Write(const std::vector<char> & source, const std::vector<char> & target, OutputBuffer & out) {
+    std::vector<int32_t> suffixes = SuffixArray::Build(source.data(), source.size());
+    Summary summary;
+    std::string encoded(magic, sizeof(magic));
+    encoded.push_back((char)version);
+    appendVarint(encoded, source.size());
+    appendVarint(encoded, target.size());
+
+    // Longest source match of the target suffix at [position], as (source offset, length)
+    auto longestMatch = [&](size_t position) -> std::pair<size_t, size_t> {
+        const char * needle = target.data() + position;
+        size_t needleLength = target.size() - position;
+        size_t low = 0, high = suffixes.size();
+        if (high == 0) return {0, 0};
+        // Suffixes in <low; high) might share longer prefix with the needle, than those outside
+        while (high - low > 1) {
+            size_t middle = low + (high - low) / 2;
+            size_t offset = suffixes[middle];
+            if (memcmp(source.data() + offset, needle, std::min(source.size() - offset, needleLength)) < 0) low = middle;
+            else high = middle;
+        }
+        size_t lowLength = commonLength(source.data() + suffixes[low], source.size() - suffixes[low], needle, needleLength);
+        if (high == suffixes.size()) return {suffixes[low], lowLength};
+        size_t highLength = commonLength(source.data() + suffixes[high], source.size() - suffixes[high], needle, needleLength);
+        return lowLength >= highLength ? std::make_pair((size_t)suffixes[low], lowLength) : std::make_pair((size_t)suffixes[high], highLength);
+    };
+
+    // Inserted bytes waiting for the next copy are <insertFrom; position)
+    size_t position = 0, insertFrom = 0, previousCopyEnd = 0;
+    auto flushInsert = [&] {
+        if (insertFrom == position) return;
+        appendVarint(encoded, (uint64_t)(position - insertFrom) << 1);
+        out << encoded;
+        out.Reference(std::string_view(target.data() + insertFrom, position - insertFrom));
+        summary.deltaBytes += encoded.size() + position - insertFrom;
+        encoded.clear();
+        summary.inserts++;
+        summary.insertedBytes += position - insertFrom;
+    };
+    while (position < target.size()) {
+        // Continuing the previous copy needs no search, and is usually the case after a short change
+        size_t offset = previousCopyEnd + (position - insertFrom);
+        size_t length = offset < source.size() ? commonLength(source.data() + offset, source.size() - offset,
+                                                              target.data() + position, target.size() - position) : 0;
+        if (length < minimumMatch) std::tie(offset, length) = longestMatch(position);
+        if (length < minimumMatch) {
+            position++;
+            continue;
+        }
+
+        flushInsert();
+        appendVarint(encoded, (uint64_t)length << 1 | 1);
+        auto distance = (int64_t)(offset - previousCopyEnd);
+        appendVarint(encoded, ((uint64_t)distance << 1) ^ (uint64_t)(distance >> 63));
+        summary.copies++;
+        summary.copiedBytes += length;
+        position += length;
+        insertFrom = position;
+        previousCopyEnd = offset + length;
+    }
+    flushInsert();
+
+    Utility::u64 hash = Utility::Hash64(target.data(), target.size());
+    for (int byte = 0; byte < 8; ++byte) encoded.push_back((char)(hash >> (8 * byte)));
+    out << encoded;
+    summary.deltaBytes += encoded.size();
+    return summary;
+}
+
+std::optional<std::vector<char>> BinaryDelta::Apply(const std::vector<char> & source, const std::vector<char> & delta, std::string & error) {
+    DeltaReader reader{delta};
+    const char * header = reader.bytes(sizeof(magic) + 1);
+    if (!header || memcmp(header, magic, sizeof(magic)) != 0) {
+        error = "not a binary delta";
+        return {};
+    }
+    if ((unsigned char)header[sizeof(magic)] != version) {
+        error = "unsupported version " + std::to_string((unsigned char)header[sizeof(magic)]);
+        return {};
+    }
+    uint64_t sourceLength = reader.varint(), targetLength = reader.varint();
+    if (!reader.good || sourceLength != source.size()) {
+        error = "delta was written for another source, of " + std::to_string(sourceLength) + " bytes";
+        return {};
+    }
+    std::vector<char> target;
+    // Length is not verified yet, do not trust it too much
+    target.reserve(std::min<uint64_t>(targetLength, ((uint64_t)source.size() + delta.size()) * 4));
+    uint64_t previousCopyEnd = 0;
+    while (reader.good && target.size() < targetLength) {
+        uint64_t instruction = reader.varint();
+        uint64_t length = instruction >> 1;
+        if (length > targetLength - target.size()) break;
+        if (!(instruction & 1)) {
+            const char * bytes = reader.bytes(length);
+            if (bytes) target.insert(target.end(), bytes, bytes + length);
+            continue;
+        }
+        uint64_t zigzag = reader.varint();
+        uint64_t offset = previousCopyEnd + (uint64_t)((int64_t)(zigzag >> 1) ^ -(int64_t)(zigzag & 1));
+        if (offset > source.size() || length > source.size() - offset) break;
+        target.insert(target.end(), source.begin() + offset, source.begin() + offset + length);
+        previousCopyEnd = offset + length;
+    }
+    const char * hash = reader.bytes(8);
+    if (!reader.good || target.size() != targetLength || !hash) {
+        error = "delta is corrupted";
+        return {};
+    }
+    Utility::u64 expected = 0;
+    for (int byte = 0; byte < 8; ++byte) expected |= (Utility::u64)(unsigned char)hash[byte] << (8 * byte);
+    if (Utility::Hash64(target.data(), target.size()) != expected) {
+        error = "reconstructed target does not match its hash";
+        return {};
+    }
+    return target;
+}
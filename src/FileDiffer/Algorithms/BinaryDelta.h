@@ -0,0 +1,55 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+
+#include "../../DataOutput/OutputBuffer.h"
+
+/// Compact binary delta of two byte sequences, in the spirit of bsdiff and VCDIFF.
+///
+/// Target is described by instructions, that either copy a range of source bytes (COPY), or add
+/// new bytes (INSERT). Copied ranges are found in a suffix array of the source: at each position
+/// of the target, the longest source match is found by binary search over the sorted suffixes.
+/// Moved or duplicated data is then copied from wherever it is in the source, instead of being
+/// deleted and added byte by byte.
+///
+/// Format, all numbers are unsigned LEB128 varints, unless noted otherwise:
+///
+///     "DFKD", version byte, source length, target length
+///     instructions: (length << 1 | 0) followed by [length] bytes for INSERT,
+///                   (length << 1 | 1) followed by zigzag-encoded distance of the copied source range
+///                   from the end of the previous one for COPY
+///     64-bit hash of the target (Utility::Hash64), little endian
+///
+/// See more here: https://www.daemonology.net/bsdiff/, https://www.rfc-editor.org/rfc/rfc3284
+class BinaryDelta {
+    /// Version of the format
+    static constexpr unsigned char version = 1;
+    /// Shorter matches cost more than inserting the bytes
+    static constexpr size_t minimumMatch = 8;
+
+public:
+    /// Statistics of written delta
+    struct Summary {
+        size_t copies = 0, copiedBytes = 0, inserts = 0, insertedBytes = 0, deltaBytes = 0;
+    };
+
+    /// Find delta from source to target and write it.
+    ///
+    /// \param source Source bytes
+    /// \param target Target bytes, they have to stay valid until [out] is flushed.
+    /// \param out Output the delta is written to
+    /// \return Statistics of the written delta
+    static Summary Write(const std::vector<char> & source, const std::vector<char> & target, OutputBuffer & out);
+
+    /// Reconstruct target from source and delta.
+    ///
+    /// \param source Source bytes, the same as when the delta was written
+    /// \param delta Delta written by [Write]
+    /// \param error Reason of failure, if the delta is invalid or does not belong to the source
+    /// \return Target bytes, or nothing, if the delta could not be applied.
+    static std::optional<std::vector<char>> Apply(const std::vector<char> & source, const std::vector<char> & delta, std::string & error);
+};
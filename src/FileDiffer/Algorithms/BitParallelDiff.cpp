@@ -0,0 +1,183 @@
+#include "BitParallelDiff.h"
+
+#include <algorithm>
+
+namespace {
+    /// Count of set bits among the lowest [bits] bits of the bit vector.
+    size_t popcountPrefix(const uint64_t * vector, size_t bits) {
+        size_t count = 0, w = 0;
+        for (; (w + 1) * 64 <= bits; ++w) count += __builtin_popcountll(vector[w]);
+        if (bits % 64 != 0) count += __builtin_popcountll(vector[w] & ((uint64_t(1) << (bits % 64)) - 1));
+        return count;
+    }
+
+    /// Value of bit at given position of the bit vector.
+    bool bitAt(const uint64_t * vector, size_t position) {
+        return (vector[position / 64] >> (position % 64)) & 1;
+    }
+}
+
+EditScript BitParallelDiff::Diff(const std::vector<char> & source, const std::vector<char> & destination) {
+    EditScript script;
+    script.reserve(std::max(source.size(), destination.size()));
+    solve(source.data(), source.size(), destination.data(), destination.size(), script);
+    return script;
+}
+
+BitParallelDiff::Pattern::Pattern(const char * data, size_t length, bool reversed) : words((length + wordBits - 1) / wordBits) {
+    positions.resize(256 * words, 0);
+    for (size_t i = 0; i < length; ++i) {
+        char byte = reversed ? data[length - 1 - i] : data[i];
+        positions[(unsigned char)byte * words + i / wordBits] |= word(1) << (i % wordBits);
+    }
+}
+
+int BitParallelDiff::advanceBlock(word & vp, word & vn, word equal, int horizontalIn, size_t outBit) {
+    word negativeIn = horizontalIn < 0 ? 1 : 0;
+    word xv = equal | vn;
+    equal |= negativeIn;
+    word xh = (((equal & vp) + vp) ^ vp) | equal;
+    word hp = vn | ~(xh | vp);
+    word hn = vp & xh;
+
+    int horizontalOut = 0;
+    if ((hp >> outBit) & 1) horizontalOut = 1;
+    else if ((hn >> outBit) & 1) horizontalOut = -1;
+
+    hp = (hp << 1) | (horizontalIn > 0 ? 1 : 0);
+    hn = (hn << 1) | negativeIn;
+    vp = hn | ~(xv | hp);
+    vn = hp & xv;
+    return horizontalOut;
+}
+
+std::vector<size_t> BitParallelDiff::lastRow(const char * source, size_t srcLength, const char * destination, size_t dstLength, bool reversed) {
+    Pattern pattern(source, srcLength, reversed);
+    std::vector<word> vp(pattern.words, ~word(0)), vn(pattern.words, 0);
+    std::vector<size_t> row(dstLength + 1);
+    row[0] = srcLength;
+    size_t lastWord = pattern.words - 1, lastBit = (srcLength - 1) % wordBits;
+    for (size_t j = 1; j <= dstLength; ++j) {
+        const word * equal = pattern.Of(reversed ? destination[dstLength - j] : destination[j - 1]);
+        // Distance grows by one in the first row of every column
+        int horizontal = 1;
+        for (size_t w = 0; w < lastWord; ++w)
+            horizontal = advanceBlock(vp[w], vn[w], equal[w], horizontal);
+        // Last row changes by horizontal delta of its cell
+        row[j] = row[j - 1] + advanceBlock(vp[lastWord], vn[lastWord], equal[lastWord], horizontal, lastBit);
+    }
+    return row;
+}
+
+void BitParallelDiff::solve(const char * source, size_t srcLength, const char * destination, size_t dstLength, EditScript & script) {
+    // Equal bytes at start or end never need to be split
+    while (srcLength > 0 && dstLength > 0 && *source == *destination) {
+        script.push_back(EditOperation::Keep);
+        source++; destination++;
+        srcLength--; dstLength--;
+    }
+    size_t commonSuffix = 0;
+    while (srcLength > 0 && dstLength > 0 && source[srcLength - 1] == destination[dstLength - 1]) {
+        srcLength--; dstLength--;
+        commonSuffix++;
+    }
+
+    size_t words = (srcLength + wordBits - 1) / wordBits;
+    if (srcLength == 0) {
+        script.insert(script.end(), dstLength, EditOperation::Add);
+    } else if (dstLength == 0) {
+        script.insert(script.end(), srcLength, EditOperation::Delete);
+    } else if (srcLength == 1) {
+        // Cannot be split. The byte is kept at its first occurrence, or it replaces the last byte
+        // (ends are not equal), the same as by the traceback of solveStored.
+        size_t kept = std::find(destination, destination + dstLength, *source) - destination;
+        if (kept == dstLength) {
+            script.insert(script.end(), dstLength - 1, EditOperation::Add);
+            script.push_back(EditOperation::Modify);
+        } else {
+            script.insert(script.end(), kept, EditOperation::Add);
+            script.push_back(EditOperation::Keep);
+            script.insert(script.end(), dstLength - kept - 1, EditOperation::Add);
+        }
+    } else if (words * dstLength * 2 <= storedWordLimit) {
+        solveStored(source, srcLength, destination, dstLength, script);
+    } else {
+        // Find where the optimal path crosses the middle row, and solve both halves
+        size_t middle = srcLength / 2;
+        std::vector<size_t> forward = lastRow(source, middle, destination, dstLength, false);
+        std::vector<size_t> backward = lastRow(source + middle, srcLength - middle, destination, dstLength, true);
+        size_t split = 0;
+        for (size_t j = 1; j <= dstLength; ++j)
+            if (forward[j] + backward[dstLength - j] < forward[split] + backward[dstLength - split]) split = j;
+        forward = {};
+        backward = {};
+        solve(source, middle, destination, split, script);
+        solve(source + middle, srcLength - middle, destination + split, dstLength - split, script);
+    }
+
+    script.insert(script.end(), commonSuffix, EditOperation::Keep);
+}
+
+void BitParallelDiff::solveStored(const char * source, size_t srcLength, const char * destination, size_t dstLength, EditScript & script) {
+    Pattern pattern(source, srcLength, false);
+    size_t words = pattern.words;
+    // Vertical deltas of column j are stored at (j - 1) * words, column 0 is always increasing by one
+    std::vector<word> vp(words * dstLength), vn(words * dstLength);
+    std::vector<word> currentVp(words, ~word(0)), currentVn(words, 0);
+    for (size_t j = 1; j <= dstLength; ++j) {
+        const word * equal = pattern.Of(destination[j - 1]);
+        int horizontal = 1;
+        for (size_t w = 0; w < words; ++w)
+            horizontal = advanceBlock(currentVp[w], currentVn[w], equal[w], horizontal);
+        std::copy(currentVp.begin(), currentVp.end(), vp.begin() + (j - 1) * words);
+        std::copy(currentVn.begin(), currentVn.end(), vn.begin() + (j - 1) * words);
+    }
+
+    // Difference between cell (i, j) and the cell above it
+    auto delta = [&](size_t i, size_t j) -> long long {
+        if (j == 0) return 1;
+        if (bitAt(vp.data() + (j - 1) * words, i - 1)) return 1;
+        if (bitAt(vn.data() + (j - 1) * words, i - 1)) return -1;
+        return 0;
+    };
+    // Value of cell (i, j), summed from the first row
+    auto cell = [&](size_t i, size_t j) -> long long {
+        if (j == 0) return i;
+        return (long long)(j + popcountPrefix(vp.data() + (j - 1) * words, i)) - (long long)popcountPrefix(vn.data() + (j - 1) * words, i);
+    };
+
+    // Walk back from the bottom-right corner, preferring the same steps as levenshtein matrix traceback.
+    // Cell to the left is only summed up when the column changes.
+    EditScript reversed;
+    size_t i = srcLength, j = dstLength;
+    long long current = cell(i, j), left = cell(i, j - 1);
+    while (i > 0 || j > 0) {
+        if (i > 0 && j > 0) {
+            long long top = current - delta(i, j), leftTop = left - delta(i, j - 1);
+            long long minimum = std::min(std::min(top, left), leftTop);
+            if (minimum == leftTop) {
+                reversed.push_back(current == leftTop ? EditOperation::Keep : EditOperation::Modify);
+                i--; j--;
+                current = leftTop;
+                if (j > 0) left = cell(i, j - 1);
+            } else if (minimum == left) {
+                reversed.push_back(EditOperation::Add);
+                j--;
+                current = left;
+                if (j > 0) left = cell(i, j - 1);
+            } else {
+                reversed.push_back(EditOperation::Delete);
+                i--;
+                current = top;
+                left = leftTop;
+            }
+        } else if (j > 0) {
+            reversed.push_back(EditOperation::Add);
+            j--;
+        } else {
+            reversed.push_back(EditOperation::Delete);
+            i--;
+        }
+    }
+    script.insert(script.end(), reversed.rbegin(), reversed.rend());
+}
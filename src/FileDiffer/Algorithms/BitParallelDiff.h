@@ -0,0 +1,76 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+#include "../DataStructures/EditScript.h"
+
+/// Bit-parallel levenshtein distance of byte sequences, by Gene Myers and Heikki Hyyrö.
+///
+/// Instead of single cells, a whole column of levenshtein matrix is computed at once.
+/// Column is stored as two bit vectors - which cells are one larger (VP) and which
+/// are one smaller (VN) than the cell above them. 64 cells are computed by a handful
+/// of word operations, with help of a table of source positions of each byte value.
+///
+/// Bit vectors of all columns are kept for the traceback, as long as they fit
+/// into memory limit. Larger inputs are split like in HirschbergDiff, where last rows
+/// of both halves are computed bit-parallel as well. The edit distance is always minimal.
+///
+/// See more here: https://doi.org/10.1145/316542.316550 (Myers),
+/// http://www.mi.fu-berlin.de/wiki/pub/ABI/RnaSeqP4/myers-bitvector-verification.pdf (Hyyrö)
+class BitParallelDiff {
+    typedef uint64_t word;
+    static constexpr size_t wordBits = 64;
+    /// Maximum count of words kept for the traceback, larger inputs are split
+    static constexpr size_t storedWordLimit = 1 << 22;
+
+public:
+    /// Find minimal edit script between two byte vectors.
+    ///
+    /// \param source Bytes of source file.
+    /// \param destination Bytes of destination file.
+    /// \return Edit script with the lowest possible levenshtein distance.
+    static EditScript Diff(const std::vector<char> & source, const std::vector<char> & destination);
+
+private:
+    /// Table of positions of each byte value in source, one bit per position.
+    class Pattern {
+        /// Words of each byte value, one after another
+        std::vector<word> positions;
+
+    public:
+        /// Count of words per byte value
+        size_t words;
+
+        /// \param data Source bytes
+        /// \param length Count of source bytes
+        /// \param reversed Whether to index the bytes from the end
+        Pattern(const char * data, size_t length, bool reversed);
+
+        /// Positions of given byte, as array of [words] words.
+        const word * Of(char byte) const { return positions.data() + (unsigned char)byte * words; }
+    };
+
+    /// Compute one 64-cell block of the next column.
+    ///
+    /// \param vp Vertical positive deltas of the block, updated in place
+    /// \param vn Vertical negative deltas of the block, updated in place
+    /// \param equal Positions in the block, where source byte equals current destination byte
+    /// \param horizontalIn Horizontal delta (-1, 0, 1) of the cell above the block
+    /// \param outBit Cell of the block whose horizontal delta is returned
+    /// \return Horizontal delta of the cell at [outBit], by default the last cell of the block
+    static int advanceBlock(word & vp, word & vn, word equal, int horizontalIn, size_t outBit = wordBits - 1);
+
+    /// Compute last row of levenshtein matrix of source and destination.
+    ///
+    /// \param reversed Whether to diff both byte ranges from their ends
+    /// \return Distances between the whole source and first j bytes of destination, for j in <0; dstLength>.
+    static std::vector<size_t> lastRow(const char * source, size_t srcLength, const char * destination, size_t dstLength, bool reversed);
+
+    /// Append edit script of source -> destination to the script, splitting the input if needed.
+    static void solve(const char * source, size_t srcLength, const char * destination, size_t dstLength, EditScript & script);
+
+    /// Append edit script of source -> destination to the script, keeping all columns in memory.
+    static void solveStored(const char * source, size_t srcLength, const char * destination, size_t dstLength, EditScript & script);
+};
@@ -0,0 +1,41 @@
+#include "ContentDefinedChunks.h"
+
+namespace {
+    /// Random value of each byte, generated by splitmix64, so it is the same on every run
+    struct GearTable {
+        uint64_t values[256];
+
+        GearTable() : values() {
+            uint64_t state = 0x2545f4914f6cdd1d;
+            for (uint64_t & value : values) {
+                uint64_t z = (state += 0x9e3779b97f4a7c15);
+                z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+                z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+                value = z ^ (z >> 31);
+            }
+        }
+    };
+    const GearTable gear;
+}
+
+std::vector<size_t> ContentDefinedChunks::Split(const char * data, size_t length) {
+    const uint64_t boundaryMask = ~uint64_t(0) << (64 - boundaryBits);
+    std::vector<size_t> starts;
+    size_t start = 0;
+    while (start < length) {
+        starts.push_back(start);
+        size_t end = start + maximumSize < length ? start + maximumSize : length;
+        size_t position = start + minimumSize < end ? start + minimumSize : end;
+        uint64_t hash = 0;
+        for (; position < end; ++position) {
+            hash = (hash << 1) + gear.values[(unsigned char)data[position]];
+            if ((hash & boundaryMask) == 0) {
+                position++;
+                break;
+            }
+        }
+        start = position;
+    }
+    starts.push_back(length);
+    return starts;
+}
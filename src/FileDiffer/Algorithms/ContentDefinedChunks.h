@@ -0,0 +1,31 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+/// Content-defined chunking of bytes, with rolling Gear hash (see FastCDC).
+///
+/// Every byte shifts the hash by one bit and adds a random value of the byte, so the highest
+/// bits of the hash depend on the last few dozen bytes only. A chunk ends, where these
+/// bits are all zero. Boundaries are then given by content around them, not by their offset,
+/// so an insertion or a deletion changes only the chunks around it, and the rest of the
+/// file is split the same way as before, even though it is shifted.
+///
+/// See more here: https://www.usenix.org/conference/atc16/technical-sessions/presentation/xia
+class ContentDefinedChunks {
+    /// Chunks are never shorter, except for the last one
+    static constexpr size_t minimumSize = 1 << 10;
+    /// Chunks are never longer
+    static constexpr size_t maximumSize = 1 << 15;
+    /// Count of highest bits of the hash that have to be zero, chunks are 2^bits + minimumSize long on average
+    static constexpr unsigned boundaryBits = 12;
+
+public:
+    /// Split bytes into chunks.
+    ///
+    /// \param data Bytes to split
+    /// \param length Count of the bytes
+    /// \return Offset of start of each chunk, followed by [length]. Empty input has no chunks.
+    static std::vector<size_t> Split(const char * data, size_t length);
+};
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+
+#include "PatienceDiff.h"
+
+/// Pre-pass, that narrows down parts of two files, which actually need to be diffed.
+///
+/// Common prefix and suffix of both files is stripped, as they are kept
+/// in any minimal edit script. Optionally, the rest is split at anchors -
+/// chunks that are unique in both files, and are in the same order in both
+/// of them (see PatienceDiff). Everything outside of the returned windows
+/// is kept unchanged, so only windows have to be passed to a diffing algorithm.
+///
+/// Note that splitting at anchors may not preserve minimal edit distance.
+class DiffWindows {
+public:
+    /// Part of source and destination, that has to be diffed.
+    /// Source range is <srcFrom; srcTo), destination range is <dstFrom; dstTo).
+    struct Window {
+        size_t srcFrom, srcTo, dstFrom, dstTo;
+    };
+
+    /// Find parts of source and destination, that have to be diffed.
+    ///
+    /// \tparam T The chunk type. The type has to provide `==` operator and std::hash.
+    /// \param source Vector of chunks of source file.
+    /// \param destination Vector of chunks of destination file.
+    /// \param splitAtAnchors Whether to split the files at chunks unique to both of them.
+    /// \return Windows ordered from the start of the files. They do not overlap, and all chunks
+    /// between them are equal in both files.
+    //
+    // This has to be implemented in header, bc of templates.
+    template<typename T>
+    static std::vector<Window> Find(const std::vector<T> & source, const std::vector<T> & destination, bool splitAtAnchors) {
+        std::vector<Window> windows;
+        Window whole = trim(source, destination, {0, source.size(), 0, destination.size()});
+        if (!splitAtAnchors || isEmpty(whole)) {
+            if (!isEmpty(whole)) windows.push_back(whole);
+            return windows;
+        }
+
+        size_t srcFrom = whole.srcFrom, dstFrom = whole.dstFrom;
+        for (const auto & anchor : PatienceDiff::FindAnchors(source, whole.srcFrom, whole.srcTo,
+                                                             destination, whole.dstFrom, whole.dstTo)) {
+            Window gap = trim(source, destination, {srcFrom, anchor.first, dstFrom, anchor.second});
+            if (!isEmpty(gap)) windows.push_back(gap);
+            srcFrom = anchor.first + 1;
+            dstFrom = anchor.second + 1;
+        }
+        Window gap = trim(source, destination, {srcFrom, whole.srcTo, dstFrom, whole.dstTo});
+        if (!isEmpty(gap)) windows.push_back(gap);
+        return windows;
+    }
+
+private:
+    /// Strip common prefix and suffix of the window
+    template<typename T>
+    static Window trim(const std::vector<T> & source, const std::vector<T> & destination, Window window) {
+        while (window.srcFrom < window.srcTo && window.dstFrom < window.dstTo
+               && source[window.srcFrom] == destination[window.dstFrom]) {
+            window.srcFrom++;
+            window.dstFrom++;
+        }
+        while (window.srcFrom < window.srcTo && window.dstFrom < window.dstTo
+               && source[window.srcTo - 1] == destination[window.dstTo - 1]) {
+            window.srcTo--;
+            window.dstTo--;
+        }
+        return window;
+    }
+
+    /// Whether there is nothing to diff in the window
+    static bool isEmpty(const Window & window) {
+        return window.srcFrom == window.srcTo && window.dstFrom == window.dstTo;
+    }
+};
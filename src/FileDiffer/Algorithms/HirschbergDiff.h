@@ -0,0 +1,152 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <type_traits>
+
+#include "../DataStructures/EditScript.h"
+#include "LevenshteinKernel.h"
+
+/// Linear-space divide and conquer algorithm by Dan Hirschberg.
+///
+/// Finds the same (minimal) edit distance as fully computed levenshtein
+/// matrix, including modifications, but only ever keeps two rows
+/// of the matrix in memory. The source is split in half, and the column
+/// where the optimal path crosses the middle row is found by computing
+/// the last row of the upper half forwards, and of the lower half backwards.
+/// Both halves are then solved recursively.
+///
+/// Runtime is O(N*M), memory usage is O(N+M).
+///
+/// See more here: https://en.wikipedia.org/wiki/Hirschberg%27s_algorithm
+class HirschbergDiff {
+    /// Type of one cell of computed row
+    typedef uint32_t cell;
+
+public:
+    /// Find minimal edit script between two vectors of type T.
+    ///
+    /// \tparam T The chunk type. The type has to provide `==` operator.
+    /// \param source Vector of chunks of source file.
+    /// \param destination Vector of chunks of destination file.
+    /// \return Edit script with the lowest possible levenshtein distance.
+    //
+    // This has to be implemented in header, bc of templates.
+    template<typename T>
+    static EditScript Diff(const std::vector<T> & source, const std::vector<T> & destination) {
+        EditScript script;
+        script.reserve(std::max(source.size(), destination.size()));
+        std::vector<cell> forward(destination.size() + 1), backward(destination.size() + 1);
+        solve(source, 0, source.size(), destination, 0, destination.size(), forward, backward, script);
+        return script;
+    }
+
+private:
+    /// Append edit script of source[srcFrom; srcTo) -> destination[dstFrom; dstTo) to the script.
+    template<typename T>
+    static void solve(const std::vector<T> & source, size_t srcFrom, size_t srcTo,
+                      const std::vector<T> & destination, size_t dstFrom, size_t dstTo,
+                      std::vector<cell> & forward, std::vector<cell> & backward, EditScript & script) {
+        // Equal chunks at start or end never need to be split
+        while (srcFrom < srcTo && dstFrom < dstTo && source[srcFrom] == destination[dstFrom]) {
+            script.push_back(EditOperation::Keep);
+            srcFrom++;
+            dstFrom++;
+        }
+        size_t commonSuffix = 0;
+        while (srcFrom < srcTo && dstFrom < dstTo && source[srcTo - 1] == destination[dstTo - 1]) {
+            srcTo--;
+            dstTo--;
+            commonSuffix++;
+        }
+
+        size_t srcLen = srcTo - srcFrom, dstLen = dstTo - dstFrom;
+        if (srcLen == 0) {
+            script.insert(script.end(), dstLen, EditOperation::Add);
+        } else if (dstLen == 0) {
+            script.insert(script.end(), srcLen, EditOperation::Delete);
+        } else if (srcLen == 1 || dstLen == 1) {
+            // First and last chunks differ (see above), so one chunk is either kept somewhere
+            // in the middle, or modified to the first chunk of the other side.
+            if (srcLen == 1) {
+                size_t keptAt = dstLen;
+                for (size_t j = 1; j + 1 < dstLen; ++j)
+                    if (source[srcFrom] == destination[dstFrom + j]) { keptAt = j; break; }
+                if (keptAt == dstLen) {
+                    script.push_back(EditOperation::Modify);
+                    script.insert(script.end(), dstLen - 1, EditOperation::Add);
+                } else {
+                    script.insert(script.end(), keptAt, EditOperation::Add);
+                    script.push_back(EditOperation::Keep);
+                    script.insert(script.end(), dstLen - keptAt - 1, EditOperation::Add);
+                }
+            } else {
+                size_t keptAt = srcLen;
+                for (size_t i = 1; i + 1 < srcLen; ++i)
+                    if (source[srcFrom + i] == destination[dstFrom]) { keptAt = i; break; }
+                if (keptAt == srcLen) {
+                    script.push_back(EditOperation::Modify);
+                    script.insert(script.end(), srcLen - 1, EditOperation::Delete);
+                } else {
+                    script.insert(script.end(), keptAt, EditOperation::Delete);
+                    script.push_back(EditOperation::Keep);
+                    script.insert(script.end(), srcLen - keptAt - 1, EditOperation::Delete);
+                }
+            }
+        } else {
+            size_t srcMid = srcFrom + srcLen / 2;
+
+            // Last row of the upper half, computed from the top-left corner
+            lastRow(source, srcFrom, srcMid, destination, dstFrom, dstTo, false, forward);
+            // First row of the lower half, computed from the bottom-right corner.
+            // backward[j] is the distance of suffixes starting at srcMid and dstTo - j.
+            lastRow(source, srcMid, srcTo, destination, dstFrom, dstTo, true, backward);
+
+            // Column, where the optimal path crosses the middle row
+            size_t split = 0;
+            cell best = forward[0] + backward[dstLen];
+            for (size_t j = 1; j <= dstLen; ++j) {
+                if (forward[j] + backward[dstLen - j] < best) {
+                    best = forward[j] + backward[dstLen - j];
+                    split = j;
+                }
+            }
+
+            solve(source, srcFrom, srcMid, destination, dstFrom, dstFrom + split, forward, backward, script);
+            solve(source, srcMid, srcTo, destination, dstFrom + split, dstTo, forward, backward, script);
+        }
+
+        script.insert(script.end(), commonSuffix, EditOperation::Keep);
+    }
+
+    /// Compute last row of levenshtein matrix of source[srcFrom; srcTo) and destination[dstFrom; dstTo)
+    /// into row[0; dstTo - dstFrom]. If reversed, both ranges are diffed from their ends.
+    template<typename T>
+    static void lastRow(const std::vector<T> & source, size_t srcFrom, size_t srcTo,
+                        const std::vector<T> & destination, size_t dstFrom, size_t dstTo,
+                        bool reversed, std::vector<cell> & row) {
+        size_t dstLen = dstTo - dstFrom;
+        if constexpr (std::is_same<T, uint32_t>::value) {
+            if (LevenshteinKernel::Supports(srcTo - srcFrom, dstLen)) {
+                LevenshteinKernel::LastRow(source.data() + srcFrom, srcTo - srcFrom, destination.data() + dstFrom, dstLen,
+                                           reversed, row.data());
+                return;
+            }
+        }
+
+        row[0] = 0;
+        for (size_t j = 1; j <= dstLen; ++j) row[j] = j;
+        for (size_t k = 0; k < srcTo - srcFrom; ++k) {
+            const T & chunk = reversed ? source[srcTo - 1 - k] : source[srcFrom + k];
+            cell diagonal = row[0];
+            row[0]++;
+            for (size_t j = 1; j <= dstLen; ++j) {
+                cell modification = diagonal + (chunk == destination[reversed ? dstTo - j : dstFrom + j - 1] ? 0 : 1);
+                diagonal = row[j];
+                row[j] = std::min(modification, std::min(row[j], row[j - 1]) + 1);
+            }
+        }
+    }
+};
@@ -0,0 +1,198 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <unordered_map>
+#include <map>
+#include <limits>
+#include <iterator>
+#include <algorithm>
+
+#include "../DataStructures/EditScript.h"
+#include "MyersDiff.h"
+
+/// Histogram diff algorithm, as implemented in JGit and git.
+///
+/// Extension of PatienceDiff, that also anchors on chunks that are
+/// not unique, preferring the ones that occur the least. Source chunks
+/// are counted, and the longest common regions around the least frequent
+/// chunks shared with destination are used to split the diff into smaller
+/// ones, which are diffed recursively.
+///
+/// Chunks are numbered and their source positions listed only once, sub-ranges
+/// count occurrences by binary search in those lists. All regions of the least
+/// frequent chunks, that do not cross each other, split the range at once
+/// (longest first), so a range of many equally rare chunks is not split
+/// off one region at a time.
+///
+/// Ranges, where every shared chunk occurs too often, are diffed by MyersDiff.
+class HistogramDiff {
+    /// Chunks that occur more often than this in the source range are not used as anchors
+    static constexpr size_t maxOccurrences = 64;
+    /// Number of destination chunks, that do not occur in source at all
+    static constexpr size_t noChunk = std::numeric_limits<size_t>::max();
+
+public:
+    /// Find edit script between two vectors of type T.
+    ///
+    /// \tparam T The chunk type. The type has to provide `==` operator and std::hash.
+    /// \param source Vector of chunks of source file.
+    /// \param destination Vector of chunks of destination file.
+    /// \return Edit script, that consists of Keep, Add and Delete operations.
+    //
+    // This has to be implemented in header, bc of templates.
+    template<typename T>
+    static EditScript Diff(const std::vector<T> & source, const std::vector<T> & destination) {
+        Index index;
+        std::unordered_map<T, size_t> numbers;
+        numbers.reserve(source.size());
+        index.source.reserve(source.size());
+        for (size_t i = 0; i < source.size(); ++i) {
+            auto inserted = numbers.emplace(source[i], index.positions.size());
+            if (inserted.second) index.positions.emplace_back();
+            index.source.push_back(inserted.first->second);
+            index.positions[inserted.first->second].push_back(i);
+        }
+        index.destination.reserve(destination.size());
+        for (const T & chunk : destination) {
+            auto it = numbers.find(chunk);
+            index.destination.push_back(it == numbers.end() ? noChunk : it->second);
+        }
+
+        EditScript script;
+        script.reserve(source.size() + destination.size());
+        solve(index, 0, source.size(), 0, destination.size(), script);
+        return script;
+    }
+
+private:
+    /// Both files as chunk numbers, equal chunks have equal numbers
+    struct Index {
+        std::vector<size_t> source, destination;
+        /// Ascending source positions of each chunk
+        std::vector<std::vector<size_t>> positions;
+
+        /// Source positions of the chunk within source[srcFrom; srcTo)
+        std::pair<const size_t *, const size_t *> PositionsIn(size_t chunk, size_t srcFrom, size_t srcTo) const {
+            const std::vector<size_t> & all = positions[chunk];
+            const size_t * from = std::lower_bound(all.data(), all.data() + all.size(), srcFrom);
+            const size_t * to = std::lower_bound(from, all.data() + all.size(), srcTo);
+            return {from, to};
+        }
+    };
+
+    /// Common region of source and destination
+    struct Region {
+        size_t srcFrom = 0, srcTo = 0, dstFrom = 0, dstTo = 0;
+        /// Lowest occurrence count of any source chunk of the region
+        size_t occurrences = 0;
+    };
+
+    /// Append edit script of source[srcFrom; srcTo) -> destination[dstFrom; dstTo) to the script.
+    static void solve(const Index & index, size_t srcFrom, size_t srcTo, size_t dstFrom, size_t dstTo, EditScript & script) {
+        size_t commonSuffix = 0;
+        // Part after the last region is solved by the next iteration, instead of recursion
+        while (true) {
+            while (srcFrom < srcTo && dstFrom < dstTo && index.source[srcFrom] == index.destination[dstFrom]) {
+                script.push_back(EditOperation::Keep);
+                srcFrom++;
+                dstFrom++;
+            }
+            while (srcFrom < srcTo && dstFrom < dstTo && index.source[srcTo - 1] == index.destination[dstTo - 1]) {
+                srcTo--;
+                dstTo--;
+                commonSuffix++;
+            }
+            if (srcFrom == srcTo || dstFrom == dstTo) break;
+
+            bool foundCommon = false;
+            std::vector<Region> regions = findRegions(index, srcFrom, srcTo, dstFrom, dstTo, foundCommon);
+            if (regions.empty()) {
+                // Only chunks that occur too often are shared
+                if (foundCommon) {
+                    MyersDiff::DiffRange(index.source, srcFrom, srcTo, index.destination, dstFrom, dstTo, script);
+                    srcFrom = srcTo;
+                    dstFrom = dstTo;
+                }
+                break;
+            }
+            for (const Region & region : regions) {
+                solve(index, srcFrom, region.srcFrom, dstFrom, region.dstFrom, script);
+                script.insert(script.end(), region.srcTo - region.srcFrom, EditOperation::Keep);
+                srcFrom = region.srcTo;
+                dstFrom = region.dstTo;
+            }
+        }
+
+        script.insert(script.end(), srcTo - srcFrom, EditOperation::Delete);
+        script.insert(script.end(), dstTo - dstFrom, EditOperation::Add);
+        script.insert(script.end(), commonSuffix, EditOperation::Keep);
+    }
+
+    /// Find the longest common regions around the least frequent shared chunks.
+    ///
+    /// \param foundCommon Set to true, if any chunk is shared by both ranges at all.
+    /// \return Regions, that do not cross each other, ordered from the start of the files.
+    /// Empty, if every shared chunk occurs too often.
+    static std::vector<Region> findRegions(const Index & index, size_t srcFrom, size_t srcTo,
+                                           size_t dstFrom, size_t dstTo, bool & foundCommon) {
+        auto occurrences = [&](size_t i) {
+            auto positions = index.PositionsIn(index.source[i], srcFrom, srcTo);
+            return (size_t)(positions.second - positions.first);
+        };
+
+        // Regions around the least frequent chunks found so far
+        std::vector<Region> candidates;
+        for (size_t j = dstFrom; j < dstTo; ) {
+            size_t nextJ = j + 1;
+            if (index.destination[j] != noChunk) {
+                auto positions = index.PositionsIn(index.destination[j], srcFrom, srcTo);
+                size_t count = positions.second - positions.first;
+                if (count > 0) foundCommon = true;
+                if (count > 0 && count <= maxOccurrences && (candidates.empty() || count <= candidates.front().occurrences)) {
+                    for (const size_t * i = positions.first; i != positions.second; ++i) {
+                        Region region {*i, *i + 1, j, j + 1, count};
+                        while (region.srcFrom > srcFrom && region.dstFrom > dstFrom
+                               && index.source[region.srcFrom - 1] == index.destination[region.dstFrom - 1]) {
+                            region.srcFrom--;
+                            region.dstFrom--;
+                            region.occurrences = std::min(region.occurrences, occurrences(region.srcFrom));
+                        }
+                        while (region.srcTo < srcTo && region.dstTo < dstTo
+                               && index.source[region.srcTo] == index.destination[region.dstTo]) {
+                            region.occurrences = std::min(region.occurrences, occurrences(region.srcTo));
+                            region.srcTo++;
+                            region.dstTo++;
+                        }
+
+                        if (!candidates.empty() && region.occurrences < candidates.front().occurrences) candidates.clear();
+                        if (candidates.empty() || region.occurrences == candidates.front().occurrences) candidates.push_back(region);
+                        // Destination chunks within this region were already tried
+                        if (region.dstTo > nextJ) nextJ = region.dstTo;
+                    }
+                }
+            }
+            j = nextJ;
+        }
+
+        // Longest regions first, each kept only if it is ordered the same way against the kept ones
+        std::stable_sort(candidates.begin(), candidates.end(), [](const Region & lhs, const Region & rhs) {
+            return lhs.srcTo - lhs.srcFrom > rhs.srcTo - rhs.srcFrom;
+        });
+        std::map<size_t, Region> kept;
+        for (const Region & region : candidates) {
+            auto next = kept.lower_bound(region.dstFrom);
+            if (next != kept.end() && (next->second.dstFrom < region.dstTo || next->second.srcFrom < region.srcTo)) continue;
+            if (next != kept.begin()) {
+                const Region & previous = std::prev(next)->second;
+                if (previous.dstTo > region.dstFrom || previous.srcTo > region.srcFrom) continue;
+            }
+            kept.emplace_hint(next, region.dstFrom, region);
+        }
+
+        std::vector<Region> regions;
+        regions.reserve(kept.size());
+        for (const auto & region : kept) regions.push_back(region.second);
+        return regions;
+    }
+};
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <algorithm>
+#include <type_traits>
+
+#include "../DataStructures/LevenshteinMatrix.h"
+#include "LevenshteinKernel.h"
+
+/// Cost of each edit operation, one per edited chunk.
+struct UnitCost {
+    static constexpr size_t deletion = 1;
+    static constexpr size_t addition = 1;
+    static constexpr size_t modification = 1;
+};
+
+/// Fill of levenshtein matrix, specialized at compile time for the chunk type,
+/// the way chunks are compared, and the cost of edit operations.
+///
+/// Cells are read from and written to the matrix storage directly, as narrow or wide cells,
+/// and cells outside of precision range are represented by the maximum of the cell type.
+/// No cell goes through std::optional or std::function, so the whole row loop is inlined.
+///
+/// Hashes compared by value with unit cost (text files, directories) are filled by
+/// LevenshteinKernel, with vector instructions.
+///
+/// \tparam T The chunk type.
+/// \tparam Equal Functor that decides, whether two chunks are equal.
+/// \tparam Cost Cost of edit operations, see UnitCost.
+template<typename T, typename Equal = std::equal_to<T>, typename Cost = UnitCost>
+class LevenshteinEngine {
+    /// Whether the vectorized kernel computes the same matrix
+    static constexpr bool vectorized = std::is_same<T, uint32_t>::value && std::is_same<Equal, std::equal_to<T>>::value
+                                       && std::is_same<Cost, UnitCost>::value;
+
+public:
+    /// Fill whole matrix, including the first row and column.
+    ///
+    /// \param matrix Matrix constructed with destination.size()+1 rows and source.size()+1 cols.
+    /// \param source Vector of chunks of source file.
+    /// \param destination Vector of chunks of destination file.
+    static void Fill(LevenshteinMatrix & matrix, const std::vector<T> & source, const std::vector<T> & destination) {
+        if constexpr (vectorized) {
+            if (LevenshteinKernel::Supports(source.size(), destination.size())) {
+                LevenshteinKernel::Fill(matrix, source, destination);
+                return;
+            }
+        }
+        FillEdges(matrix, source.size(), destination.size());
+        for (size_t i = 1; i <= source.size() && !destination.empty(); ++i) {
+            FillTile(matrix, source, destination, i, i + 1, 1, destination.size());
+            FillTile(matrix, source, destination, i, i + 1, destination.size(), destination.size() + 1);
+        }
+    }
+
+    /// Fill the first row and column of the matrix.
+    static void FillEdges(LevenshteinMatrix & matrix, size_t sourceSize, size_t destinationSize) {
+        for (size_t i = 0; i <= sourceSize; ++i) matrix.Set(i, 0, i * Cost::deletion);
+        for (size_t j = 0; j <= destinationSize; ++j) matrix.Set(0, j, j * Cost::addition);
+    }
+
+    /// Fill cells of rows <rowFrom; rowTo) and columns <colFrom; colTo) within precision range.
+    /// Column colFrom == destination.size() is the last column of the matrix. Cells above and
+    /// to the left of the tile have to be filled already. Tiles that do not overlap can be
+    /// filled concurrently, see TiledFill.
+    static void FillTile(LevenshteinMatrix & matrix, const std::vector<T> & source, const std::vector<T> & destination,
+                         size_t rowFrom, size_t rowTo, size_t colFrom, size_t colTo) {
+        if (colFrom != destination.size()) {
+            if constexpr (vectorized) {
+                if (LevenshteinKernel::Supports(source.size(), destination.size())) {
+                    LevenshteinKernel::FillTile(matrix, source, destination, rowFrom, rowTo, colFrom, colTo);
+                    return;
+                }
+            }
+        }
+        if (matrix.narrow) fillTile(matrix, matrix.narrowCells, source, destination, rowFrom, rowTo, colFrom, colTo);
+        else fillTile(matrix, matrix.wideCells, source, destination, rowFrom, rowTo, colFrom, colTo);
+    }
+
+private:
+    template<typename Cell>
+    static void fillTile(LevenshteinMatrix & matrix, std::vector<Cell> & cells, const std::vector<T> & source,
+                         const std::vector<T> & destination, size_t rowFrom, size_t rowTo, size_t colFrom, size_t colTo) {
+        constexpr Cell unset = std::numeric_limits<Cell>::max();
+        // Value of any neighbour, or [unset]
+        auto at = [&](size_t row, size_t col) -> Cell {
+            size_t index = matrix.getCoord(row, col);
+            return index == LevenshteinMatrix::outside ? unset : cells[index];
+        };
+        // Cheapest way to reach a cell from its neighbours. Neighbours that are [unset] are skipped.
+        auto cheapest = [](Cell top, Cell left, Cell diagonal, bool equal) -> Cell {
+            size_t best = std::numeric_limits<size_t>::max();
+            if (top != unset) best = (size_t)top + Cost::deletion;
+            if (left != unset) best = std::min(best, (size_t)left + Cost::addition);
+            if (diagonal != unset) best = std::min(best, (size_t)diagonal + (equal ? 0 : Cost::modification));
+            return best >= unset ? unset : (Cell)best;
+        };
+        Equal equal;
+
+        if (colFrom == destination.size()) {
+            for (size_t i = rowFrom; i < rowTo; ++i)
+                cells[matrix.lastColumnOffset + i] = cheapest(cells[matrix.lastColumnOffset + i - 1], at(i, colFrom - 1),
+                                                              at(i - 1, colFrom - 1), equal(source[i - 1], destination[colFrom - 1]));
+            return;
+        }
+
+        for (size_t i = rowFrom; i < rowTo; ++i) {
+            size_t begin = std::max(colFrom, matrix.bandBegin[i]), end = std::min(colTo, matrix.bandEnd[i]);
+            if (begin >= end) continue;
+            size_t previousBegin = matrix.bandBegin[i - 1], previousEnd = matrix.bandEnd[i - 1];
+            Cell * row = cells.data() + matrix.rowOffset[i];
+            const Cell * previous = cells.data() + matrix.rowOffset[i - 1];
+            const T & chunk = source[i - 1];
+
+            Cell left = at(i, begin - 1);
+            for (size_t j = begin; j < end; ++j) {
+                Cell top = j >= previousBegin && j < previousEnd ? previous[j - previousBegin] : unset;
+                Cell diagonal = j - 1 >= previousBegin && j - 1 < previousEnd ? previous[j - 1 - previousBegin]
+                                : j == 1 ? cells[matrix.firstColumnOffset + i - 1] : unset;
+                left = cheapest(top, left, diagonal, equal(chunk, destination[j - 1]));
+                row[j - matrix.bandBegin[i]] = left;
+            }
+        }
+    }
+};
@@ -0,0 +1,213 @@
+#include "LevenshteinKernel.h"
+
+#include <algorithm>
+#include <limits>
+#include <iterator>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define LEVENSHTEIN_KERNEL_X86
+#endif
+
+bool LevenshteinKernel::Supports(size_t sourceSize, size_t destinationSize) {
+    // Cells minus column index have to fit into signed 32-bit lanes
+    return sourceSize > 0 && destinationSize > 0 && sourceSize + destinationSize < (size_t(1) << 29);
+}
+
+const char * LevenshteinKernel::InstructionSet() {
+    RowFunction row = selectRowFunction();
+    if (row == rowAvx2) return "AVX2";
+    if (row == rowSse41) return "SSE4.1";
+    return "scalar";
+}
+
+LevenshteinKernel::RowFunction LevenshteinKernel::selectRowFunction() {
+#ifdef LEVENSHTEIN_KERNEL_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return rowAvx2;
+    if (__builtin_cpu_supports("sse4.1")) return rowSse41;
+#endif
+    return rowScalar;
+}
+
+void LevenshteinKernel::Fill(LevenshteinMatrix & matrix, const std::vector<uint32_t> & source, const std::vector<uint32_t> & destination) {
+    static const RowFunction row = selectRowFunction();
+    size_t dstSize = destination.size();
+
+    // Two rows indexed by column. Cells outside precision range are kept [unset], so the row function
+    // does not have to check the range of the previous row.
+    std::vector<int32_t> previous(dstSize + 1), current(dstSize + 1, unset);
+    for (size_t j = 0; j <= dstSize; ++j) {
+        previous[j] = (int32_t)j;
+        matrix.Set(0, j, j);
+    }
+    // Range of current buffer that still contains cells of row i-2
+    size_t previousBegin = 1, previousEnd = dstSize, staleBegin = 0, staleEnd = 0;
+
+    for (size_t i = 1; i <= source.size(); ++i) {
+        size_t begin = matrix.bandBegin[i], end = std::max(begin, std::min(matrix.bandEnd[i], dstSize));
+        std::fill(current.begin() + staleBegin, current.begin() + std::max(staleBegin, std::min(staleEnd, begin)), unset);
+        std::fill(current.begin() + std::min(staleEnd, std::max(staleBegin, end)), current.begin() + staleEnd, unset);
+
+        current[0] = (int32_t)i;
+        if (begin < end) row(previous.data(), current.data(), destination.data(), source[i - 1], begin, end);
+        // The last column is always part of the matrix
+        int32_t cost = source[i - 1] == destination[dstSize - 1] ? 0 : 1;
+        current[dstSize] = std::min({previous[dstSize] + 1, current[dstSize - 1] + 1, previous[dstSize - 1] + cost, unset});
+
+        matrix.Set(i, 0, i);
+        if (current[dstSize] != unset) matrix.Set(i, dstSize, current[dstSize]);
+        storeRow(matrix, i, begin, end, current.data() + begin);
+
+        std::swap(previous, current);
+        staleBegin = previousBegin;
+        staleEnd = previousEnd;
+        previousBegin = begin;
+        previousEnd = end;
+    }
+}
+
+void LevenshteinKernel::FillTile(LevenshteinMatrix & matrix, const std::vector<uint32_t> & source, const std::vector<uint32_t> & destination,
+                                 size_t rowFrom, size_t rowTo, size_t colFrom, size_t colTo) {
+    static const RowFunction row = selectRowFunction();
+    auto cell = [&](size_t i, size_t j) -> int32_t {
+        std::optional<size_t> value = matrix.Get(i, j);
+        return value.has_value() ? (int32_t)*value : unset;
+    };
+
+    // Rows of the tile, with one more column on the left. Column j is at index j - (colFrom - 1).
+    size_t width = colTo - colFrom + 1;
+    std::vector<int32_t> previous(width), current(width);
+    for (size_t k = 0; k < width; ++k) previous[k] = cell(rowFrom - 1, colFrom - 1 + k);
+
+    for (size_t i = rowFrom; i < rowTo; ++i) {
+        size_t begin = std::max(colFrom, matrix.bandBegin[i]), end = std::min(colTo, matrix.bandEnd[i]);
+        current[0] = cell(i, colFrom - 1);
+        std::fill(current.begin() + 1, current.end(), unset);
+        if (begin < end) {
+            row(previous.data(), current.data(), destination.data() + colFrom - 1, source[i - 1],
+                begin - colFrom + 1, end - colFrom + 1);
+            storeRow(matrix, i, begin, end, current.data() + begin - colFrom + 1);
+        }
+        std::swap(previous, current);
+    }
+}
+
+void LevenshteinKernel::LastRow(const uint32_t * source, size_t srcLength, const uint32_t * destination, size_t dstLength,
+                                bool reversed, uint32_t * row) {
+    static const RowFunction rowFunction = selectRowFunction();
+    // Vector loads need the destination in the order of columns
+    std::vector<uint32_t> reversedDestination;
+    if (reversed) {
+        reversedDestination.assign(std::reverse_iterator<const uint32_t *>(destination + dstLength),
+                                   std::reverse_iterator<const uint32_t *>(destination));
+        destination = reversedDestination.data();
+    }
+
+    std::vector<int32_t> previous(dstLength + 1), current(dstLength + 1);
+    for (size_t j = 0; j <= dstLength; ++j) previous[j] = (int32_t)j;
+    for (size_t i = 1; i <= srcLength; ++i) {
+        current[0] = (int32_t)i;
+        rowFunction(previous.data(), current.data(), destination, reversed ? source[srcLength - i] : source[i - 1], 1, dstLength + 1);
+        std::swap(previous, current);
+    }
+    std::copy(previous.begin(), previous.end(), row);
+}
+
+void LevenshteinKernel::storeRow(LevenshteinMatrix & matrix, size_t row, size_t begin, size_t end, const int32_t * cells) {
+    size_t offset = matrix.rowOffset[row] + begin - matrix.bandBegin[row];
+    if (matrix.narrow) {
+        uint16_t * out = matrix.narrowCells.data() + offset;
+        for (size_t j = 0; j < end - begin; ++j)
+            out[j] = cells[j] == unset ? std::numeric_limits<uint16_t>::max() : (uint16_t)cells[j];
+    } else {
+        uint32_t * out = matrix.wideCells.data() + offset;
+        for (size_t j = 0; j < end - begin; ++j)
+            out[j] = cells[j] == unset ? std::numeric_limits<uint32_t>::max() : (uint32_t)cells[j];
+    }
+}
+
+void LevenshteinKernel::rowScalar(const int32_t * previous, int32_t * current, const uint32_t * destination,
+                                  uint32_t sourceChunk, size_t begin, size_t end) {
+    int32_t left = current[begin - 1];
+    for (size_t j = begin; j < end; ++j) {
+        int32_t cost = destination[j - 1] == sourceChunk ? 0 : 1;
+        left = std::min({previous[j] + 1, previous[j - 1] + cost, left + 1, unset});
+        current[j] = left;
+    }
+}
+
+#ifdef LEVENSHTEIN_KERNEL_X86
+
+__attribute__((target("sse4.1")))
+void LevenshteinKernel::rowSse41(const int32_t * previous, int32_t * current, const uint32_t * destination,
+                                 uint32_t sourceChunk, size_t begin, size_t end) {
+    const __m128i one = _mm_set1_epi32(1), none = _mm_set1_epi32(unset);
+    const __m128i chunk = _mm_set1_epi32((int32_t)sourceChunk), lanes = _mm_setr_epi32(0, 1, 2, 3);
+    // Minimum of (cell - column) of all cells to the left
+    __m128i carry = _mm_set1_epi32(current[begin - 1] - (int32_t)(begin - 1));
+
+    size_t j = begin;
+    for (; j + 4 <= end; j += 4) {
+        __m128i top = _mm_loadu_si128((const __m128i *)(previous + j));
+        __m128i diagonal = _mm_loadu_si128((const __m128i *)(previous + j - 1));
+        // Equal lanes are -1, which cancels the modification cost
+        __m128i equal = _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i *)(destination + j - 1)), chunk);
+        __m128i candidate = _mm_min_epi32(_mm_add_epi32(top, one), _mm_add_epi32(diagonal, _mm_add_epi32(one, equal)));
+        candidate = _mm_min_epi32(candidate, none);
+
+        __m128i column = _mm_add_epi32(_mm_set1_epi32((int32_t)j), lanes);
+        __m128i x = _mm_sub_epi32(candidate, column);
+        x = _mm_min_epi32(x, _mm_blend_epi16(_mm_slli_si128(x, 4), none, 0x03));
+        x = _mm_min_epi32(x, _mm_blend_epi16(_mm_slli_si128(x, 8), none, 0x0F));
+        x = _mm_min_epi32(x, carry);
+        carry = _mm_shuffle_epi32(x, 0xFF);
+        _mm_storeu_si128((__m128i *)(current + j), _mm_min_epi32(_mm_add_epi32(x, column), none));
+    }
+    if (j < end) rowScalar(previous, current, destination, sourceChunk, j, end);
+}
+
+__attribute__((target("avx2")))
+void LevenshteinKernel::rowAvx2(const int32_t * previous, int32_t * current, const uint32_t * destination,
+                                uint32_t sourceChunk, size_t begin, size_t end) {
+    const __m256i one = _mm256_set1_epi32(1), none = _mm256_set1_epi32(unset);
+    const __m256i chunk = _mm256_set1_epi32((int32_t)sourceChunk), lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    const __m256i shift1 = _mm256_setr_epi32(0, 0, 1, 2, 3, 4, 5, 6), shift2 = _mm256_setr_epi32(0, 0, 0, 1, 2, 3, 4, 5);
+    const __m256i shift4 = _mm256_setr_epi32(0, 0, 0, 0, 0, 1, 2, 3), last = _mm256_set1_epi32(7);
+    // Minimum of (cell - column) of all cells to the left
+    __m256i carry = _mm256_set1_epi32(current[begin - 1] - (int32_t)(begin - 1));
+
+    size_t j = begin;
+    for (; j + 8 <= end; j += 8) {
+        __m256i top = _mm256_loadu_si256((const __m256i *)(previous + j));
+        __m256i diagonal = _mm256_loadu_si256((const __m256i *)(previous + j - 1));
+        // Equal lanes are -1, which cancels the modification cost
+        __m256i equal = _mm256_cmpeq_epi32(_mm256_loadu_si256((const __m256i *)(destination + j - 1)), chunk);
+        __m256i candidate = _mm256_min_epi32(_mm256_add_epi32(top, one), _mm256_add_epi32(diagonal, _mm256_add_epi32(one, equal)));
+        candidate = _mm256_min_epi32(candidate, none);
+
+        __m256i column = _mm256_add_epi32(_mm256_set1_epi32((int32_t)j), lanes);
+        __m256i x = _mm256_sub_epi32(candidate, column);
+        x = _mm256_min_epi32(x, _mm256_blend_epi32(_mm256_permutevar8x32_epi32(x, shift1), none, 0x01));
+        x = _mm256_min_epi32(x, _mm256_blend_epi32(_mm256_permutevar8x32_epi32(x, shift2), none, 0x03));
+        x = _mm256_min_epi32(x, _mm256_blend_epi32(_mm256_permutevar8x32_epi32(x, shift4), none, 0x0F));
+        x = _mm256_min_epi32(x, carry);
+        carry = _mm256_permutevar8x32_epi32(x, last);
+        _mm256_storeu_si256((__m256i *)(current + j), _mm256_min_epi32(_mm256_add_epi32(x, column), none));
+    }
+    if (j < end) rowScalar(previous, current, destination, sourceChunk, j, end);
+}
+
+#else
+
+void LevenshteinKernel::rowSse41(const int32_t * previous, int32_t * current, const uint32_t * destination,
+                                 uint32_t sourceChunk, size_t begin, size_t end) {
+    rowScalar(previous, current, destination, sourceChunk, begin, end);
+}
+
+void LevenshteinKernel::rowAvx2(const int32_t * previous, int32_t * current, const uint32_t * destination,
+                                uint32_t sourceChunk, size_t begin, size_t end) {
+    rowScalar(previous, current, destination, sourceChunk, begin, end);
+}
+
+#endif
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+#include "../DataStructures/LevenshteinMatrix.h"
+
+/// Vectorized fill of levenshtein matrix of two vectors of 32-bit hashes.
+///
+/// Cell depends on the cell above, above-left and to the left. First two are known for the
+/// whole row at once, so the row is computed 8 (AVX2) or 4 (SSE4.1) cells per instruction
+/// from the previous row, comparing hashes lane-wise. Dependency on the left cell is then
+/// resolved by a lane-wise prefix minimum, because cell - column equals the minimum
+/// of (candidate - column) over all cells to the left.
+///
+/// Instruction set is chosen at runtime, with a scalar fallback. The filled matrix is the same
+/// as the one filled cell by cell, including precision range.
+class LevenshteinKernel {
+public:
+    /// Row computation, see [rowScalar]
+    typedef void (*RowFunction)(const int32_t * previous, int32_t * current, const uint32_t * destination,
+                                uint32_t sourceChunk, size_t begin, size_t end);
+
+    /// Whether inputs of given size can be diffed by the kernel.
+    static bool Supports(size_t sourceSize, size_t destinationSize);
+
+    /// Name of instruction set used by the kernel on this CPU.
+    static const char * InstructionSet();
+
+    /// Fill all cells of the matrix within precision range.
+    ///
+    /// \param matrix Matrix constructed with destination.size()+1 rows and source.size()+1 cols.
+    /// \param source Hashes of source chunks.
+    /// \param destination Hashes of destination chunks.
+    static void Fill(LevenshteinMatrix & matrix, const std::vector<uint32_t> & source, const std::vector<uint32_t> & destination);
+
+    /// Fill cells of rows <rowFrom; rowTo) and columns <colFrom; colTo) within precision range.
+    /// Cells above and to the left of the tile have to be filled already. Tiles that do not
+    /// overlap can be filled concurrently.
+    ///
+    /// \param colTo Column past the tile, at most destination.size() (last column is not filled).
+    static void FillTile(LevenshteinMatrix & matrix, const std::vector<uint32_t> & source, const std::vector<uint32_t> & destination,
+                         size_t rowFrom, size_t rowTo, size_t colFrom, size_t colTo);
+
+    /// Compute last row of levenshtein matrix with unlimited precision.
+    ///
+    /// \param source Hashes of source chunks.
+    /// \param srcLength Count of source chunks.
+    /// \param destination Hashes of destination chunks.
+    /// \param dstLength Count of destination chunks.
+    /// \param reversed Whether to diff both ranges from their ends.
+    /// \param row Output of dstLength + 1 cells, distances between the source and first j destination chunks.
+    static void LastRow(const uint32_t * source, size_t srcLength, const uint32_t * destination, size_t dstLength,
+                        bool reversed, uint32_t * row);
+
+private:
+    /// Value of cells outside precision range. Grows by at most one per row, but never overflows,
+    /// because it is clamped in every row.
+    static constexpr int32_t unset = 0x3FFFFFFF;
+
+    /// Copy computed cells <begin; end) of a row into the matrix, [unset] cells are left empty.
+    static void storeRow(LevenshteinMatrix & matrix, size_t row, size_t begin, size_t end, const int32_t * cells);
+
+    /// Pick row computation, depending on CPU features.
+    static RowFunction selectRowFunction();
+
+    /// Compute cells <begin; end) of a row. Cell [begin - 1] of current row has to be filled (or [unset]).
+    ///
+    /// \param previous Cells of previous row, indexed by column. Cells outside its precision range are [unset].
+    /// \param current Cells of computed row, indexed by column.
+    /// \param destination Destination hashes, destination[j - 1] is compared in column j.
+    /// \param sourceChunk Source hash of computed row.
+    static void rowScalar(const int32_t * previous, int32_t * current, const uint32_t * destination,
+                          uint32_t sourceChunk, size_t begin, size_t end);
+    static void rowSse41(const int32_t * previous, int32_t * current, const uint32_t * destination,
+                         uint32_t sourceChunk, size_t begin, size_t end);
+    static void rowAvx2(const int32_t * previous, int32_t * current, const uint32_t * destination,
+                        uint32_t sourceChunk, size_t begin, size_t end);
+};
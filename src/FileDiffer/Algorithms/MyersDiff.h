@@ -0,0 +1,240 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <algorithm>
+#include <utility>
+
+#include "../DataStructures/EditScript.h"
+
+/// Greedy O((N+M)D) diff algorithm by Eugene W. Myers.
+///
+/// Finds the shortest edit script that consists only of additions
+/// and deletions. Runtime grows with the size of the difference (D),
+/// not with the size of the inputs, which makes it ideal for two
+/// similar versions of a large file.
+///
+/// Furthest reaching paths of each step are kept for the traceback,
+/// which takes O(D^2) memory. Once that would exceed [traceLimit], the range
+/// is split at the middle snake instead, and both halves are diffed
+/// recursively, so memory usage stays O(N+M) for very different inputs.
+///
+/// See more here: http://www.xmailserver.org/diff2.pdf
+class MyersDiff {
+    /// Furthest reaching paths kept for the traceback at most (32 MiB)
+    static constexpr std::ptrdiff_t traceLimit = std::ptrdiff_t(1) << 22;
+
+public:
+    /// Find shortest edit script between two vectors of type T.
+    ///
+    /// \tparam T The chunk type. The type has to provide `==` operator.
+    /// \param source Vector of chunks of source file.
+    /// \param destination Vector of chunks of destination file.
+    /// \return Edit script, that consists of Keep, Add and Delete operations.
+    template<typename T>
+    static EditScript Diff(const std::vector<T> & source, const std::vector<T> & destination) {
+        EditScript script;
+        script.reserve(source.size() + destination.size());
+        DiffRange(source, 0, source.size(), destination, 0, destination.size(), script);
+        return script;
+    }
+
+    /// Find shortest edit script between source[srcFrom; srcTo) and destination[dstFrom; dstTo),
+    /// and append it to the given script.
+    ///
+    /// \tparam T The chunk type. The type has to provide `==` operator.
+    /// \param source Vector of chunks of source file.
+    /// \param srcFrom First source chunk to diff
+    /// \param srcTo One past the last source chunk to diff
+    /// \param destination Vector of chunks of destination file.
+    /// \param dstFrom First destination chunk to diff
+    /// \param dstTo One past the last destination chunk to diff
+    /// \param script Edit script, to which Keep, Add and Delete operations will be appended.
+    //
+    // This has to be implemented in header, bc of templates.
+    template<typename T>
+    static void DiffRange(const std::vector<T> & source, size_t srcFrom, size_t srcTo,
+                          const std::vector<T> & destination, size_t dstFrom, size_t dstTo, EditScript & script) {
+        if (srcFrom == srcTo || dstFrom == dstTo) {
+            script.insert(script.end(), srcTo - srcFrom, EditOperation::Delete);
+            script.insert(script.end(), dstTo - dstFrom, EditOperation::Add);
+            return;
+        }
+        if (diffWithTrace(source, srcFrom, srcTo, destination, dstFrom, dstTo, script)) return;
+
+        // Too many steps for the trace, the shortest script passes through the middle snake.
+        Snake snake = middleSnake(source, srcFrom, srcTo, destination, dstFrom, dstTo);
+        DiffRange(source, srcFrom, snake.srcFrom, destination, dstFrom, snake.dstFrom, script);
+        script.insert(script.end(), snake.srcTo - snake.srcFrom, EditOperation::Keep);
+        DiffRange(source, snake.srcTo, srcTo, destination, snake.dstTo, dstTo, script);
+    }
+
+private:
+    /// Run of equal chunks source[srcFrom; srcTo) == destination[dstFrom; dstTo)
+    struct Snake {
+        size_t srcFrom = 0, srcTo = 0, dstFrom = 0, dstTo = 0;
+    };
+
+    /// Lowest and highest diagonal k = x - y after step d, that may be on a shortest path.
+    ///
+    /// Diagonals lie within <-m; n>, path on diagonal k needs at least |n - m - k| more steps,
+    /// and no script is longer than n + m. Diagonals out of this range are never visited,
+    /// so lopsided inputs (n << m) take O((N+M)min(N,M)) time instead of O(D^2).
+    static std::pair<std::ptrdiff_t, std::ptrdiff_t> diagonals(std::ptrdiff_t d, std::ptrdiff_t n, std::ptrdiff_t m) {
+        std::ptrdiff_t low = std::max({-d, -m, d - 2 * m}), high = std::min({d, n, 2 * n - d});
+        // Diagonals of step d have the same parity as d
+        if ((low - d) % 2 != 0) low++;
+        if ((high - d) % 2 != 0) high--;
+        return {low, high};
+    }
+
+    /// Furthest reaching x on diagonal k after step d, extended from the furthest reaching paths
+    /// of step d-1 on neighbouring diagonals. Diagonals out of bounds of step d-1 are not used.
+    ///
+    /// \param furthest Furthest reaching x of step d-1, indexed by k + offset.
+    /// \param previous Bounds of step d-1, see [diagonals]
+    /// \param addition Set to true, if the last edit is an addition (move down), false if deletion (move right).
+    static std::ptrdiff_t extend(const std::ptrdiff_t * furthest, std::ptrdiff_t k,
+                                 std::pair<std::ptrdiff_t, std::ptrdiff_t> previous, bool & addition) {
+        bool down = k + 1 <= previous.second, right = k - 1 >= previous.first;
+        addition = down && (!right || furthest[k - 1] < furthest[k + 1]);
+        return addition ? furthest[k + 1] : furthest[k - 1] + 1;
+    }
+
+    /// Greedy forward search, followed by traceback of the kept furthest reaching paths.
+    ///
+    /// \return False (and script untouched), if the trace would grow over [traceLimit].
+    template<typename T>
+    static bool diffWithTrace(const std::vector<T> & source, size_t srcFrom, size_t srcTo,
+                              const std::vector<T> & destination, size_t dstFrom, size_t dstTo, EditScript & script) {
+        const std::ptrdiff_t n = srcTo - srcFrom, m = dstTo - dstFrom;
+        const std::ptrdiff_t max = n + m;
+        const T * a = source.data() + srcFrom;
+        const T * b = destination.data() + dstFrom;
+
+        // Furthest reaching x on each diagonal k = x - y, indexed by k + max + 1.
+        std::vector<std::ptrdiff_t> furthestStorage(2 * max + 3, 0);
+        std::ptrdiff_t * furthest = furthestStorage.data() + max + 1;
+        // Snapshot of furthest reaching x on diagonals of step d (every other one, see [diagonals]),
+        // stored one after another. Step d starts at offset stepStart[d].
+        std::vector<std::ptrdiff_t> trace;
+        std::vector<size_t> stepStart;
+
+        std::ptrdiff_t editDistance = 0;
+        for (std::ptrdiff_t d = 0; d <= max; ++d) {
+            auto bounds = diagonals(d, n, m), previous = diagonals(d - 1, n, m);
+            if ((std::ptrdiff_t)trace.size() + (bounds.second - bounds.first) / 2 + 1 > traceLimit) return false;
+            bool reachedEnd = false;
+            for (std::ptrdiff_t k = bounds.first; k <= bounds.second; k += 2) {
+                bool addition;
+                std::ptrdiff_t x = d == 0 ? 0 : extend(furthest, k, previous, addition);
+                std::ptrdiff_t y = x - k;
+                // Follow the snake of equal chunks
+                while (x < n && y < m && a[x] == b[y]) {
+                    x++;
+                    y++;
+                }
+                furthest[k] = x;
+                if (x >= n && y >= m) reachedEnd = true;
+            }
+            stepStart.push_back(trace.size());
+            for (std::ptrdiff_t k = bounds.first; k <= bounds.second; k += 2) trace.push_back(furthest[k]);
+            if (reachedEnd) {
+                editDistance = d;
+                break;
+            }
+        }
+
+        // Walk back from the end, appending operations in reverse order, and then reverse them.
+        size_t scriptStart = script.size();
+        std::ptrdiff_t x = n, y = m;
+        for (std::ptrdiff_t d = editDistance; d > 0; --d) {
+            // Snapshot of step d-1, holding every other diagonal from the lowest one
+            auto previousBounds = diagonals(d - 1, n, m);
+            const std::ptrdiff_t * snapshot = trace.data() + stepStart[d - 1];
+            auto previous = [&](std::ptrdiff_t diagonal) { return snapshot[(diagonal - previousBounds.first) / 2]; };
+            std::ptrdiff_t k = x - y;
+            bool down = k + 1 <= previousBounds.second, right = k - 1 >= previousBounds.first;
+            bool addition = down && (!right || previous(k - 1) < previous(k + 1));
+            std::ptrdiff_t previousK = addition ? k + 1 : k - 1;
+            std::ptrdiff_t previousX = previous(previousK);
+            std::ptrdiff_t previousY = previousX - previousK;
+            // Snake started right after the edit
+            std::ptrdiff_t snakeStartX = addition ? previousX : previousX + 1;
+            while (x > snakeStartX) {
+                script.push_back(EditOperation::Keep);
+                x--;
+                y--;
+            }
+            script.push_back(addition ? EditOperation::Add : EditOperation::Delete);
+            x = previousX;
+            y = previousY;
+        }
+        // Initial snake from the top-left corner
+        while (x > 0) {
+            script.push_back(EditOperation::Keep);
+            x--;
+        }
+
+        std::reverse(script.begin() + scriptStart, script.end());
+        return true;
+    }
+
+    /// Find the middle snake of some shortest edit script, by searching forward
+    /// from the start and backward from the end at once, until the paths overlap.
+    /// Only the furthest reaching paths of the current step are kept.
+    ///
+    /// Both ranges have to be non-empty.
+    template<typename T>
+    static Snake middleSnake(const std::vector<T> & source, size_t srcFrom, size_t srcTo,
+                             const std::vector<T> & destination, size_t dstFrom, size_t dstTo) {
+        const std::ptrdiff_t n = srcTo - srcFrom, m = dstTo - dstFrom;
+        const std::ptrdiff_t delta = n - m;
+        const bool odd = delta % 2 != 0;
+        const std::ptrdiff_t max = (n + m + 1) / 2;
+        const T * a = source.data() + srcFrom;
+        const T * b = destination.data() + dstFrom;
+
+        // Furthest reaching x on each diagonal k = x - y, indexed by k + max + 1.
+        // Backward paths are measured from the end, on diagonals of the reversed inputs,
+        // which have the same bounds (see [diagonals]).
+        std::vector<std::ptrdiff_t> forwardStorage(2 * max + 3, 0), backwardStorage(2 * max + 3, 0);
+        std::ptrdiff_t * forward = forwardStorage.data() + max + 1;
+        std::ptrdiff_t * backward = backwardStorage.data() + max + 1;
+
+        for (std::ptrdiff_t d = 0; d <= max; ++d) {
+            auto bounds = diagonals(d, n, m), previous = diagonals(d - 1, n, m);
+            bool addition;
+            for (std::ptrdiff_t k = bounds.first; k <= bounds.second; k += 2) {
+                std::ptrdiff_t x = d == 0 ? 0 : extend(forward, k, previous, addition);
+                std::ptrdiff_t y = x - k;
+                const std::ptrdiff_t startX = x, startY = y;
+                while (x < n && y < m && a[x] == b[y]) {
+                    x++;
+                    y++;
+                }
+                forward[k] = x;
+                // Overlaps backward path of step d-1 on the same diagonal
+                const std::ptrdiff_t reverseK = delta - k;
+                if (odd && d > 0 && reverseK >= previous.first && reverseK <= previous.second && x + backward[reverseK] >= n)
+                    return Snake {srcFrom + startX, srcFrom + x, dstFrom + startY, dstFrom + y};
+            }
+            for (std::ptrdiff_t k = bounds.first; k <= bounds.second; k += 2) {
+                std::ptrdiff_t x = d == 0 ? 0 : extend(backward, k, previous, addition);
+                std::ptrdiff_t y = x - k;
+                const std::ptrdiff_t startX = x, startY = y;
+                while (x < n && y < m && a[n - 1 - x] == b[m - 1 - y]) {
+                    x++;
+                    y++;
+                }
+                backward[k] = x;
+                // Overlaps forward path of step d on the same diagonal
+                const std::ptrdiff_t forwardK = delta - k;
+                if (!odd && forwardK >= bounds.first && forwardK <= bounds.second && x + forward[forwardK] >= n)
+                    return Snake {srcFrom + (n - x), srcFrom + (n - startX), dstFrom + (m - y), dstFrom + (m - startY)};
+            }
+        }
+        // Unreachable, paths always meet by step ceil((N+M)/2)
+        return Snake {srcFrom, srcFrom, dstFrom, dstFrom};
+    }
+};
@@ -0,0 +1,136 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <unordered_map>
+#include <algorithm>
+
+#include "../DataStructures/EditScript.h"
+#include "MyersDiff.h"
+
+/// Patience diff algorithm by Bram Cohen.
+///
+/// Chunks that occur exactly once in both files are used as anchors.
+/// The longest sequence of anchors that appear in the same order in both
+/// files is kept, and only gaps between them are diffed recursively.
+/// Gaps without any unique chunks are diffed by MyersDiff.
+///
+/// Frequent chunks (such as `}` or empty lines in source code) are never
+/// used as anchors, so resulting hunks follow the structure of the file.
+///
+/// See more here: https://bramcohen.livejournal.com/73318.html
+class PatienceDiff {
+public:
+    /// Find edit script between two vectors of type T.
+    ///
+    /// \tparam T The chunk type. The type has to provide `==` operator and std::hash.
+    /// \param source Vector of chunks of source file.
+    /// \param destination Vector of chunks of destination file.
+    /// \return Edit script, that consists of Keep, Add and Delete operations.
+    //
+    // This has to be implemented in header, bc of templates.
+    template<typename T>
+    static EditScript Diff(const std::vector<T> & source, const std::vector<T> & destination) {
+        EditScript script;
+        script.reserve(source.size() + destination.size());
+        solve(source, 0, source.size(), destination, 0, destination.size(), script);
+        return script;
+    }
+
+    /// Find chunks unique in both source[srcFrom; srcTo) and destination[dstFrom; dstTo), and return the longest
+    /// sequence of them, that is ordered the same way in both files.
+    ///
+    /// \tparam T The chunk type. The type has to provide `==` operator and std::hash.
+    /// \return Anchors as pairs (source index, destination index), ordered from the start of the files.
+    //
+    // This has to be implemented in header, bc of templates.
+    template<typename T>
+    static std::vector<std::pair<size_t, size_t>> FindAnchors(const std::vector<T> & source, size_t srcFrom, size_t srcTo,
+                                                              const std::vector<T> & destination, size_t dstFrom, size_t dstTo) {
+        std::unordered_map<T, Occurrence> occurrences;
+        occurrences.reserve(srcTo - srcFrom);
+        for (size_t i = srcFrom; i < srcTo; ++i) {
+            Occurrence & occurrence = occurrences[source[i]];
+            occurrence.sourceCount++;
+            occurrence.sourceIndex = i;
+        }
+        for (size_t j = dstFrom; j < dstTo; ++j) {
+            auto it = occurrences.find(destination[j]);
+            if (it == occurrences.end()) continue;
+            it->second.destinationCount++;
+            it->second.destinationIndex = j;
+        }
+
+        // Unique chunks, ordered by their position in source
+        std::vector<std::pair<size_t, size_t>> unique;
+        for (size_t i = srcFrom; i < srcTo; ++i) {
+            const Occurrence & occurrence = occurrences.at(source[i]);
+            if (occurrence.sourceCount == 1 && occurrence.destinationCount == 1)
+                unique.emplace_back(i, occurrence.destinationIndex);
+        }
+        if (unique.empty()) return {};
+
+        // Longest increasing subsequence of destination indexes, by patience sorting.
+        // Each pile keeps index (into unique) of its top card, each card remembers top of the previous pile.
+        std::vector<size_t> pileTops;
+        std::vector<size_t> previousCard(unique.size());
+        for (size_t card = 0; card < unique.size(); ++card) {
+            auto pile = std::lower_bound(pileTops.begin(), pileTops.end(), unique[card].second,
+                                         [&unique](size_t top, size_t value) { return unique[top].second < value; });
+            previousCard[card] = pile == pileTops.begin() ? unique.size() : *(pile - 1);
+            if (pile == pileTops.end()) pileTops.push_back(card);
+            else *pile = card;
+        }
+
+        std::vector<std::pair<size_t, size_t>> anchors;
+        for (size_t card = pileTops.back(); card != unique.size(); card = previousCard[card])
+            anchors.push_back(unique[card]);
+        std::reverse(anchors.begin(), anchors.end());
+        return anchors;
+    }
+
+private:
+    /// Occurrences of one chunk in the diffed range
+    struct Occurrence {
+        size_t sourceCount = 0, destinationCount = 0;
+        size_t sourceIndex = 0, destinationIndex = 0;
+    };
+
+    /// Append edit script of source[srcFrom; srcTo) -> destination[dstFrom; dstTo) to the script.
+    template<typename T>
+    static void solve(const std::vector<T> & source, size_t srcFrom, size_t srcTo,
+                      const std::vector<T> & destination, size_t dstFrom, size_t dstTo, EditScript & script) {
+        while (srcFrom < srcTo && dstFrom < dstTo && source[srcFrom] == destination[dstFrom]) {
+            script.push_back(EditOperation::Keep);
+            srcFrom++;
+            dstFrom++;
+        }
+        size_t commonSuffix = 0;
+        while (srcFrom < srcTo && dstFrom < dstTo && source[srcTo - 1] == destination[dstTo - 1]) {
+            srcTo--;
+            dstTo--;
+            commonSuffix++;
+        }
+
+        if (srcFrom == srcTo || dstFrom == dstTo) {
+            script.insert(script.end(), srcTo - srcFrom, EditOperation::Delete);
+            script.insert(script.end(), dstTo - dstFrom, EditOperation::Add);
+        } else {
+            std::vector<std::pair<size_t, size_t>> anchors = FindAnchors(source, srcFrom, srcTo, destination, dstFrom, dstTo);
+            if (anchors.empty()) {
+                MyersDiff::DiffRange(source, srcFrom, srcTo, destination, dstFrom, dstTo, script);
+            } else {
+                for (const auto & anchor : anchors) {
+                    solve(source, srcFrom, anchor.first, destination, dstFrom, anchor.second, script);
+                    script.push_back(EditOperation::Keep);
+                    srcFrom = anchor.first + 1;
+                    dstFrom = anchor.second + 1;
+                }
+                solve(source, srcFrom, srcTo, destination, dstFrom, dstTo, script);
+            }
+        }
+
+        script.insert(script.end(), commonSuffix, EditOperation::Keep);
+    }
+
+};
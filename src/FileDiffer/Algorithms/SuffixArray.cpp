@@ -0,0 +1,103 @@
+#include "SuffixArray.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <limits>
+
+namespace {
+    /// SA-IS of symbols <0; upper>.
+    template<typename Symbol>
+    std::vector<int32_t> buildSuffixArray(const Symbol * s, int32_t n, int32_t upper) {
+        if (n == 0) return {};
+        if (n == 1) return {0};
+        if (n == 2) return s[0] < s[1] ? std::vector<int32_t>{0, 1} : std::vector<int32_t>{1, 0};
+
+        std::vector<int32_t> sa(n);
+        // Whether each suffix is S-type (smaller than the next one)
+        std::vector<bool> sType(n);
+        for (int32_t i = n - 2; i >= 0; i--)
+            sType[i] = s[i] == s[i + 1] ? sType[i + 1] : s[i] < s[i + 1];
+
+        // Start of L-type and S-type part of bucket of each symbol
+        std::vector<int32_t> startL(upper + 2), startS(upper + 1);
+        for (int32_t i = 0; i < n; i++) {
+            if (!sType[i]) startS[s[i]]++;
+            else startL[s[i] + 1]++;
+        }
+        for (int32_t c = 0; c <= upper; c++) {
+            startS[c] += startL[c];
+            if (c < upper) startL[c + 1] += startS[c];
+        }
+
+        // Sort all suffixes from sorted (or just bucketed) LMS suffixes
+        auto induce = [&](const std::vector<int32_t> & lms) {
+            std::fill(sa.begin(), sa.end(), -1);
+            std::vector<int32_t> bucket(startS.begin(), startS.end());
+            for (int32_t d : lms)
+                if (d != n) sa[bucket[s[d]]++] = d;
+            bucket.assign(startL.begin(), startL.begin() + upper + 1);
+            sa[bucket[s[n - 1]]++] = n - 1;
+            for (int32_t i = 0; i < n; i++) {
+                int32_t v = sa[i];
+                if (v >= 1 && !sType[v - 1]) sa[bucket[s[v - 1]]++] = v - 1;
+            }
+            bucket.assign(startL.begin(), startL.begin() + upper + 1);
+            for (int32_t i = n - 1; i >= 0; i--) {
+                int32_t v = sa[i];
+                if (v >= 1 && sType[v - 1]) sa[--bucket[s[v - 1] + 1]] = v - 1;
+            }
+        };
+
+        // Index of each LMS suffix among all LMS suffixes, or -1
+        std::vector<int32_t> lmsIndex(n + 1, -1);
+        std::vector<int32_t> lms;
+        for (int32_t i = 1; i < n; i++) {
+            if (!sType[i - 1] && sType[i]) {
+                lmsIndex[i] = (int32_t)lms.size();
+                lms.push_back(i);
+            }
+        }
+        auto m = (int32_t)lms.size();
+        induce(lms);
+        if (m == 0) return sa;
+
+        std::vector<int32_t> sortedLms;
+        sortedLms.reserve(m);
+        for (int32_t v : sa)
+            if (lmsIndex[v] != -1) sortedLms.push_back(v);
+
+        // Name LMS substrings by their rank, equal substrings get the same name
+        std::vector<int32_t> names(m);
+        int32_t lastName = 0;
+        names[lmsIndex[sortedLms[0]]] = 0;
+        for (int32_t i = 1; i < m; i++) {
+            int32_t l = sortedLms[i - 1], r = sortedLms[i];
+            int32_t endL = lmsIndex[l] + 1 < m ? lms[lmsIndex[l] + 1] : n;
+            int32_t endR = lmsIndex[r] + 1 < m ? lms[lmsIndex[r] + 1] : n;
+            bool same = true;
+            if (endL - l != endR - r) {
+                same = false;
+            } else {
+                while (l < endL && s[l] == s[r]) {
+                    l++;
+                    r++;
+                }
+                if (l == n || s[l] != s[r]) same = false;
+            }
+            if (!same) lastName++;
+            names[lmsIndex[sortedLms[i]]] = lastName;
+        }
+        lmsIndex = {};
+
+        std::vector<int32_t> namesSuffixArray = buildSuffixArray(names.data(), m, lastName);
+        for (int32_t i = 0; i < m; i++) sortedLms[i] = lms[namesSuffixArray[i]];
+        induce(sortedLms);
+        return sa;
+    }
+}
+
+std::vector<int32_t> SuffixArray::Build(const char * data, size_t length) {
+    if (length >= (size_t)std::numeric_limits<int32_t>::max())
+        throw std::length_error("Input is too large for suffix array.");
+    return buildSuffixArray((const unsigned char *)data, (int32_t)length, 255);
+}
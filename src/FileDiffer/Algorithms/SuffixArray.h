@@ -0,0 +1,24 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+/// Suffix array of bytes - starts of all suffixes of the bytes, in lexicographical order
+/// of the suffixes. Built by SA-IS algorithm in linear time.
+///
+/// Suffixes are classified as S-type (smaller than the next suffix) or L-type (larger).
+/// Leftmost S-type suffixes (LMS) of each run split the input into substrings, which are sorted
+/// by induced sorting from their first characters. If some of them are equal, they are named
+/// by their rank and sorted recursively. All other suffixes are then induced from the sorted LMS suffixes.
+///
+/// See more here: https://doi.org/10.1109/DCC.2009.42 (Nong, Zhang, Chan)
+class SuffixArray {
+public:
+    /// Build suffix array of the bytes.
+    ///
+    /// \param data Bytes
+    /// \param length Count of the bytes, less than 2^31
+    /// \return Start of each suffix, in lexicographical order of the suffixes (bytes compared as unsigned).
+    static std::vector<int32_t> Build(const char * data, size_t length);
+};
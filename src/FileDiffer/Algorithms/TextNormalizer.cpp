@@ -0,0 +1,116 @@
+#include "TextNormalizer.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define TEXT_NORMALIZER_X86
+#endif
+
+namespace {
+    /// Whether SSSE3 normalization is used on this CPU
+    bool supportsSsse3() {
+#ifdef TEXT_NORMALIZER_X86
+        static const bool supported = [] {
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("ssse3") != 0;
+        }();
+        return supported;
+#else
+        return false;
+#endif
+    }
+
+    /// For each 8-bit mask of kept bytes, indexes of the kept bytes, packed at the start.
+    /// Unused positions have the highest bit set, so shuffle zeroes them.
+    struct PackPatterns {
+        unsigned char indexes[256][8];
+
+        PackPatterns() : indexes() {
+            for (unsigned mask = 0; mask < 256; ++mask) {
+                size_t count = 0;
+                for (unsigned char bit = 0; bit < 8; ++bit)
+                    if (mask & (1u << bit)) indexes[mask][count++] = bit;
+                while (count < 8) indexes[mask][count++] = 0x80;
+            }
+        }
+    };
+    const PackPatterns packPatterns;
+}
+
+TextNormalizer::TextNormalizer(bool skipWhitespace, bool foldCase) : skipWhitespace(skipWhitespace), foldCase(foldCase) {
+    for (unsigned byte = 0; byte < 256; ++byte) {
+        bool whitespace = byte == ' ' || (byte >= '\t' && byte <= '\r');
+        folded[byte] = (unsigned char)(foldCase && byte >= 'A' && byte <= 'Z' ? byte + ('a' - 'A') : byte);
+        kept[byte] = !(skipWhitespace && whitespace);
+    }
+}
+
+std::string_view TextNormalizer::Normalize(std::string_view line) {
+    if (!skipWhitespace && !foldCase) return line;
+
+    if (buffer.size() < line.size() + 16) buffer.resize(line.size() + 16);
+    size_t consumed = 0, written = 0;
+    if (supportsSsse3()) written = normalizeSsse3(line.data(), line.size(), buffer.data(), consumed);
+    written += normalizeScalar(line.data() + consumed, line.size() - consumed, buffer.data() + written);
+    return std::string_view(buffer.data(), written);
+}
+
+size_t TextNormalizer::normalizeScalar(const char * in, size_t length, char * out) const {
+    size_t written = 0;
+    for (size_t i = 0; i < length; ++i) {
+        auto byte = (unsigned char)in[i];
+        // Skipped byte is overwritten by the next one
+        out[written] = (char)folded[byte];
+        written += kept[byte];
+    }
+    return written;
+}
+
+#ifdef TEXT_NORMALIZER_X86
+
+__attribute__((target("ssse3")))
+size_t TextNormalizer::normalizeSsse3(const char * in, size_t length, char * out, size_t & consumed) const {
+    // Unsigned (x - low) < count, compared as signed bytes with flipped highest bit
+    const __m128i flip = _mm_set1_epi8((char)0x80);
+    const __m128i upperLow = _mm_set1_epi8('A'), upperLimit = _mm_set1_epi8((char)(0x80 + 26));
+    const __m128i controlLow = _mm_set1_epi8('\t'), controlLimit = _mm_set1_epi8((char)(0x80 + 5));
+    const __m128i space = _mm_set1_epi8(' '), caseBit = _mm_set1_epi8('a' - 'A'), highHalf = _mm_set1_epi8(8);
+
+    size_t written = 0, i = 0;
+    for (; i + 16 <= length; i += 16) {
+        __m128i block = _mm_loadu_si128((const __m128i *)(in + i));
+        if (foldCase) {
+            __m128i upper = _mm_cmplt_epi8(_mm_xor_si128(_mm_sub_epi8(block, upperLow), flip), upperLimit);
+            block = _mm_add_epi8(block, _mm_and_si128(upper, caseBit));
+        }
+        unsigned skipped = 0;
+        if (skipWhitespace) {
+            __m128i control = _mm_cmplt_epi8(_mm_xor_si128(_mm_sub_epi8(block, controlLow), flip), controlLimit);
+            skipped = (unsigned)_mm_movemask_epi8(_mm_or_si128(control, _mm_cmpeq_epi8(block, space)));
+        }
+        if (skipped == 0) {
+            _mm_storeu_si128((__m128i *)(out + written), block);
+            written += 16;
+            continue;
+        }
+
+        unsigned keptLow = ~skipped & 0xFF, keptHigh = (~skipped >> 8) & 0xFF;
+        __m128i pattern = _mm_unpacklo_epi64(_mm_loadl_epi64((const __m128i *)packPatterns.indexes[keptLow]),
+                                             _mm_add_epi8(_mm_loadl_epi64((const __m128i *)packPatterns.indexes[keptHigh]), highHalf));
+        __m128i packed = _mm_shuffle_epi8(block, pattern);
+        _mm_storel_epi64((__m128i *)(out + written), packed);
+        written += __builtin_popcount(keptLow);
+        _mm_storel_epi64((__m128i *)(out + written), _mm_srli_si128(packed, 8));
+        written += __builtin_popcount(keptHigh);
+    }
+    consumed = i;
+    return written;
+}
+
+#else
+
+size_t TextNormalizer::normalizeSsse3(const char *, size_t, char *, size_t & consumed) const {
+    consumed = 0;
+    return 0;
+}
+
+#endif
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+/// Normalization of lines of text files, that are not compared strictly. Whitespace is skipped
+/// and letters are case-folded in one pass, the same way as by `isspace` and `tolower` in the
+/// "C" locale, that is, bytes outside of ASCII are kept as they are.
+///
+/// Line is normalized 16 bytes at a time with SSSE3, if the CPU supports it. Whitespace is
+/// found and letters are folded lane-wise, then the kept bytes of each half are packed
+/// together by one shuffle. The rest of the line (or whole line without SSSE3) is normalized
+/// by a table, that maps each byte to its folded value and whether it is kept.
+///
+/// Normalized line is written to a buffer reused by all lines, so no line is allocated.
+class TextNormalizer {
+    /// Whether whitespace is skipped
+    bool skipWhitespace;
+    /// Whether letters are case-folded
+    bool foldCase;
+    /// Folded value of each byte
+    unsigned char folded[256];
+    /// Whether each byte is kept (1) or skipped (0)
+    unsigned char kept[256];
+    /// Normalized line. Vector stores write whole 16 bytes, so it is longer than the line.
+    std::vector<char> buffer;
+
+public:
+    /// \param skipWhitespace Whether whitespace is skipped
+    /// \param foldCase Whether letters are case-folded
+    TextNormalizer(bool skipWhitespace, bool foldCase);
+
+    /// Normalize the line.
+    ///
+    /// \param line Line to normalize
+    /// \return View of the normalized line, valid until the next call. If nothing is normalized,
+    /// it is the line itself.
+    std::string_view Normalize(std::string_view line);
+
+private:
+    /// Normalize [length] bytes starting at [in] by the table, write them to [out].
+    ///
+    /// \return Count of written bytes
+    size_t normalizeScalar(const char * in, size_t length, char * out) const;
+    /// Normalize as many whole 16-byte blocks of [length] bytes starting at [in] as possible,
+    /// write them to [out]. At least 16 bytes past the written ones might be overwritten.
+    ///
+    /// \param consumed Count of read bytes
+    /// \return Count of written bytes
+    size_t normalizeSsse3(const char * in, size_t length, char * out, size_t & consumed) const;
+};
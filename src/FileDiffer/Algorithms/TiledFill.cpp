@@ -0,0 +1,85 @@
+#include "TiledFill.h"
+#include "../../ThreadPool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+void TiledFill::Run(const LevenshteinMatrix & matrix, size_t sourceSize, size_t destinationSize, size_t jobs,
+                    const TileFunction & fillTile) {
+    if (sourceSize == 0 || destinationSize == 0) return;
+    if (jobs == 0) jobs = ThreadPool::HardwareThreads();
+
+    // Tiles are small enough to keep every thread busy on the widest row
+    size_t widestBand = 1;
+    for (size_t i = 1; i <= sourceSize; ++i)
+        if (matrix.BandEnd(i) > matrix.BandBegin(i)) widestBand = std::max(widestBand, matrix.BandEnd(i) - matrix.BandBegin(i));
+    size_t tileSize = std::max(minimumTileSize, widestBand / (4 * jobs));
+
+    struct Tile {
+        size_t rowFrom, rowTo, colFrom, colTo;
+        /// Count of tiles that have to be filled before this one
+        size_t dependencies = 0;
+        std::vector<size_t> dependents;
+    };
+    std::vector<Tile> tiles;
+    // Per block of rows: index of its first tile, and range of its column blocks <firstBlock; endBlock).
+    // Tile of the last column follows the band tiles of the block.
+    std::vector<size_t> firstTile, firstBlock, endBlock;
+    auto dependOn = [&](size_t tile, size_t dependency) {
+        tiles[dependency].dependents.push_back(tile);
+        tiles[tile].dependencies++;
+    };
+    auto bandTile = [&](size_t rowBlock, size_t colBlock) -> std::ptrdiff_t {
+        if (colBlock < firstBlock[rowBlock] || colBlock >= endBlock[rowBlock]) return -1;
+        return firstTile[rowBlock] + (colBlock - firstBlock[rowBlock]);
+    };
+
+    for (size_t rowBlock = 0, rowFrom = 1; rowFrom <= sourceSize; ++rowBlock, rowFrom += tileSize) {
+        size_t rowTo = std::min(sourceSize + 1, rowFrom + tileSize);
+        size_t bandBegin = destinationSize, bandEnd = 0;
+        for (size_t i = rowFrom; i < rowTo; ++i) {
+            if (matrix.BandEnd(i) <= matrix.BandBegin(i)) continue;
+            bandBegin = std::min(bandBegin, matrix.BandBegin(i));
+            bandEnd = std::max(bandEnd, matrix.BandEnd(i));
+        }
+        firstTile.push_back(tiles.size());
+        if (bandBegin < bandEnd) {
+            firstBlock.push_back((bandBegin - 1) / tileSize);
+            endBlock.push_back((bandEnd - 2) / tileSize + 1);
+        } else {
+            firstBlock.push_back(0);
+            endBlock.push_back(0);
+        }
+
+        for (size_t colBlock = firstBlock[rowBlock]; colBlock < endBlock[rowBlock]; ++colBlock) {
+            size_t colFrom = 1 + colBlock * tileSize;
+            tiles.push_back({rowFrom, rowTo, colFrom, std::min(destinationSize, colFrom + tileSize)});
+            size_t tile = tiles.size() - 1;
+            if (colBlock > firstBlock[rowBlock]) dependOn(tile, tile - 1);
+            if (rowBlock > 0) {
+                if (bandTile(rowBlock - 1, colBlock) >= 0) dependOn(tile, bandTile(rowBlock - 1, colBlock));
+                if (colBlock > 0 && bandTile(rowBlock - 1, colBlock - 1) >= 0) dependOn(tile, bandTile(rowBlock - 1, colBlock - 1));
+            }
+        }
+        // Last column depends on the whole band of this block, and on the last column above
+        tiles.push_back({rowFrom, rowTo, destinationSize, destinationSize + 1});
+        size_t lastColumn = tiles.size() - 1;
+        if (endBlock[rowBlock] > firstBlock[rowBlock]) dependOn(lastColumn, lastColumn - 1);
+        if (rowBlock > 0) dependOn(lastColumn, firstTile[rowBlock] - 1);
+    }
+
+    ThreadPool pool(jobs);
+    std::unique_ptr<std::atomic<size_t>[]> remaining(new std::atomic<size_t>[tiles.size()]);
+    for (size_t tile = 0; tile < tiles.size(); ++tile) remaining[tile] = tiles[tile].dependencies;
+
+    std::function<void(size_t)> run = [&](size_t tile) {
+        fillTile(tiles[tile].rowFrom, tiles[tile].rowTo, tiles[tile].colFrom, tiles[tile].colTo);
+        for (size_t dependent : tiles[tile].dependents)
+            if (--remaining[dependent] == 0) pool.Submit([&run, dependent] { run(dependent); });
+    };
+    for (size_t tile = 0; tile < tiles.size(); ++tile)
+        if (tiles[tile].dependencies == 0) pool.Submit([&run, tile] { run(tile); });
+    pool.Wait();
+}
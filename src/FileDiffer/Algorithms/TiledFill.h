@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+
+#include "../DataStructures/LevenshteinMatrix.h"
+
+/// Parallel fill of levenshtein matrix, tile by tile.
+///
+/// Matrix is split into square tiles, and each tile is filled once tiles above, to the left
+/// and above-left of it are filled. Tiles on the same anti-diagonal are thus filled
+/// concurrently, in a wavefront going from the top-left to the bottom-right corner.
+/// Only tiles that intersect precision range are created. The last column of the matrix,
+/// which is always part of it, has its own column of tiles.
+///
+/// Every cell is computed from the same neighbours as in the row by row fill,
+/// so the matrix is exactly the same, no matter the count of threads.
+class TiledFill {
+    /// Smallest width and height of a tile, so that the workers are not busy only synchronizing
+    static constexpr size_t minimumTileSize = 64;
+
+public:
+    /// Fill cells of rows <rowFrom; rowTo) and columns <colFrom; colTo) that lie within precision
+    /// range. Column colFrom == destination size is the last column of the matrix.
+    typedef std::function<void(size_t rowFrom, size_t rowTo, size_t colFrom, size_t colTo)> TileFunction;
+
+    /// Fill whole matrix except the first row and column, which have to be already filled.
+    ///
+    /// \param matrix The matrix, used to determine precision range of each row.
+    /// \param sourceSize Count of source chunks (rows - 1 of the matrix).
+    /// \param destinationSize Count of destination chunks (cols - 1 of the matrix).
+    /// \param jobs Count of threads, 0 means one per hardware thread.
+    /// \param fillTile Function that fills one tile. Called concurrently, for different tiles.
+    static void Run(const LevenshteinMatrix & matrix, size_t sourceSize, size_t destinationSize, size_t jobs,
+                    const TileFunction & fillTile);
+};
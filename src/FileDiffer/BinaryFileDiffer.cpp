@@ -1,24 +1,26 @@
 #include "BinaryFileDiffer.h"
 
-BinaryFileDiffer::BinaryFileDiffer(const std::string & filename, const LoadMode & mode, std::optional<size_t> precision, Logger & logger) : FileDiffer(mode, logger, precision, filename) { }
+BinaryFileDiffer::BinaryFileDiffer(const std::string & filename, const LoadMode & mode, const DiffOptions & options, Logger & logger) : FileDiffer(mode, logger, options, filename) { }
 
-std::optional<DataDifference> BinaryFileDiffer::Diff(const FileDiffer &other) const {
+bool BinaryFileDiffer::Diff(const FileDiffer &other, DeltaSink &sink) const {
     const auto * binaryRhs = dynamic_cast<const BinaryFileDiffer *>(&other);
     if (binaryRhs == nullptr) {
         // TODO: downcast `other` to binary?
         logger.Log("Cannot compare binary data type (left) with non-binary data type (right). Aborting.", Severity::Critical);
-        return {};
+        return false;
     }
 
-    LevenshteinMatrix matrix = constructLevenshteinMatrix(data, binaryRhs->data);
+    if (options.contentDefinedChunks || std::max(data.size(), binaryRhs->data.size()) >= chunkingThreshold) {
+        diffByChunks(*binaryRhs, sink);
+        return true;
+    }
 
-    DataDifference result = levenshteinMatrixToDeltas<char>(matrix, data, binaryRhs->data, binaryRhs->filename,
-                                                      [this](size_t idx) -> std::string { return Utility::numberToHexString(
-                                                              data[idx]); },
-                                                      [binaryRhs](size_t idx) -> std::string { return Utility::numberToHexString(
-                                                              binaryRhs->data[idx]); });
+    diffChunks<char>(data, binaryRhs->data, binaryRhs->filename,
+                     [this](size_t idx) -> std::string_view { return displayByte(data[idx]); },
+                     [binaryRhs](size_t idx) -> std::string_view { return displayByte(binaryRhs->data[idx]); },
+                     sink);
 
-    return result;
+    return true;
 }
 
 bool BinaryFileDiffer::LoadData() {
@@ -29,9 +31,22 @@ bool BinaryFileDiffer::LoadData() {
         return false;
     }
 
-    data = std::vector<char>((std::istreambuf_iterator<char>(inputStream)), std::istreambuf_iterator<char>());
+    // Read whole file at once, if its size is known, otherwise (pipes) byte by byte
+    inputStream.seekg(0, std::ios::end);
+    std::streamoff size = inputStream.tellg();
+    if (size > 0) {
+        data.resize((size_t)size);
+        inputStream.seekg(0, std::ios::beg);
+        inputStream.read(data.data(), size);
+        data.resize((size_t)inputStream.gcount());
+    } else {
+        inputStream.clear();
+        inputStream.seekg(0, std::ios::beg);
+        data = std::vector<char>((std::istreambuf_iterator<char>(inputStream)), std::istreambuf_iterator<char>());
+    }
 
-    if (data.empty()) {
+    // Missing side of an added or deleted file is /dev/null on purpose
+    if (data.empty() && options.warnEmptyFiles && filename != "/dev/null") {
         logger.Log("No bytes were read from \"" + filename + "\", is the file empty?", Severity::Warning);
     }
     logger.Log("File \"" + filename + "\" loaded successfully. Loaded total of " + std::to_string(data.size()) + " bytes.", Severity::Debug);
@@ -42,17 +57,91 @@ DataContext BinaryFileDiffer::generateContext(size_t offset) const {
     const size_t context_before_len = 8;
     const size_t context_after_len = 8;
 
-    DataContext result;
+    return DataContext(offset, data.size(), context_before_len, context_after_len);
+}
+
+std::string_view BinaryFileDiffer::displayByte(char byte) {
+    static const std::vector<std::string> display = [] {
+        std::vector<std::string> result;
+        for (int value = 0; value < 256; ++value) result.push_back(Utility::numberToHexString<char>((char)value));
+        return result;
+    }();
+    return display[(unsigned char)byte];
+}
+
+void BinaryFileDiffer::diffByChunks(const BinaryFileDiffer & rhs, DeltaSink & sink) const {
+    std::vector<size_t> srcStarts = ContentDefinedChunks::Split(data.data(), data.size());
+    std::vector<size_t> dstStarts = ContentDefinedChunks::Split(rhs.data.data(), rhs.data.size());
+    auto hashChunks = [](const std::vector<char> & bytes, const std::vector<size_t> & starts) {
+        std::vector<Utility::u64> hashes;
+        for (size_t k = 0; k + 1 < starts.size(); ++k)
+            hashes.push_back(Utility::Hash64(bytes.data() + starts[k], starts[k + 1] - starts[k]));
+        return hashes;
+    };
+    std::vector<Utility::u64> srcHashes = hashChunks(data, srcStarts), dstHashes = hashChunks(rhs.data, dstStarts);
+
+    // Chunks of both files, source chunks first
+    auto chunk = [&](size_t idx) {
+        if (idx < srcHashes.size()) return std::string_view(data.data() + srcStarts[idx], srcStarts[idx + 1] - srcStarts[idx]);
+        idx -= srcHashes.size();
+        return std::string_view(rhs.data.data() + dstStarts[idx], dstStarts[idx + 1] - dstStarts[idx]);
+    };
+    ChunkClasses classes = classifyChunks(srcHashes, dstHashes, [&](size_t lhs, size_t rhs) { return chunk(lhs) == chunk(rhs); });
+    logger.Log("Split files into " + std::to_string(srcHashes.size()) + " and " + std::to_string(dstHashes.size())
+               + " content-defined chunks.", Severity::Info);
 
-    std::vector<char> bytes = Utility::vectorSlice(data, (offset - context_before_len > offset) ? 0 : (offset - context_before_len), offset + context_after_len);
-    std::vector<std::string> strContext;
-    std::transform(bytes.begin(), bytes.end(), back_inserter(strContext), [](char chr){return Utility::numberToHexString<char>(
-            chr);});
-    result.rawData = strContext;
+    DataDifference difference(filename, rhs.filename, {}, ForcedOutput::Default,
+                              [this](size_t idx) { return displayByte(data[idx]); },
+                              [&rhs](size_t idx) { return displayByte(rhs.data[idx]); });
+    sink.Begin(difference);
+    HunkBuilder hunks(sink, difference);
+    size_t refined = 0;
 
-    size_t lastBeforeIndexIncl = std::min((offset < context_after_len) ? offset : context_before_len, offset);
-    result.maxIdxOfBeforeContext = lastBeforeIndexIncl;
-    result.maxIdxOfOnContext = result.maxIdxOfBeforeContext + 1; // Assume one line changed
+    for (const auto & window : DiffWindows::Find(classes.source, classes.destination, options.splitAtAnchors)) {
+        EditScript script = diffWindow(std::vector<uint32_t>(classes.source.begin() + window.srcFrom, classes.source.begin() + window.srcTo),
+                                       std::vector<uint32_t>(classes.destination.begin() + window.dstFrom, classes.destination.begin() + window.dstTo),
+                                       options.jobs);
+        // Chunks <i; gapSrc) and <j; gapDst) differ, and are refined at once, as soon as equal chunks follow
+        size_t i = window.srcFrom, j = window.dstFrom, gapSrc = i, gapDst = j;
+        auto refineGap = [&] {
+            if (gapSrc == i && gapDst == j) return;
+            refine(rhs, srcStarts[gapSrc], srcStarts[i], dstStarts[gapDst], dstStarts[j], hunks);
+            refined++;
+        };
+        for (EditOperation operation : script) {
+            if (operation == EditOperation::Keep) {
+                refineGap();
+                gapSrc = ++i;
+                gapDst = ++j;
+                continue;
+            }
+            if (operation != EditOperation::Add) i++;
+            if (operation != EditOperation::Delete) j++;
+        }
+        refineGap();
+    }
+    hunks.Finish();
 
-    return result;
+    logger.Log("Refined " + std::to_string(refined) + " differing part(s) of the files byte by byte.", Severity::Debug);
+    sink.End(difference);
+}
+
+void BinaryFileDiffer::refine(const BinaryFileDiffer & rhs, size_t srcFrom, size_t srcTo, size_t dstFrom, size_t dstTo,
+                              HunkBuilder & hunks) const {
+    std::vector<char> source(data.begin() + srcFrom, data.begin() + srcTo);
+    std::vector<char> destination(rhs.data.begin() + dstFrom, rhs.data.begin() + dstTo);
+
+    // Chunk boundaries around the change are usually shifted, strip bytes that are still the same
+    for (const auto & window : DiffWindows::Find(source, destination, false)) {
+        size_t srcLength = window.srcTo - window.srcFrom, dstLength = window.dstTo - window.dstFrom;
+        EditScript script;
+        if ((srcLength + 1) * (dstLength + 1) <= refineCellLimit) {
+            script = diffWindow(std::vector<char>(source.begin() + window.srcFrom, source.begin() + window.srcTo),
+                                std::vector<char>(destination.begin() + window.dstFrom, destination.begin() + window.dstTo), options.jobs);
+        } else {
+            script.assign(srcLength, EditOperation::Delete);
+            script.insert(script.end(), dstLength, EditOperation::Add);
+        }
+        appendEditScript(script, srcFrom + window.srcFrom, dstFrom + window.dstFrom, hunks);
+    }
 }
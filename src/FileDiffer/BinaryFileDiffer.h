@@ -3,15 +3,42 @@
 #include <vector>
 
 #include "FileDiffer.h"
+#include "Algorithms/ContentDefinedChunks.h"
 
 class BinaryFileDiffer : public FileDiffer {
     std::vector<char> data;
 
+    /// Files of at least this many bytes are diffed by content-defined chunks, even if not requested
+    static constexpr size_t chunkingThreshold = 16 << 20;
+    /// Differing parts with more cells of levenshtein matrix are not refined byte by byte,
+    /// they are replaced as a whole
+    static constexpr size_t refineCellLimit = size_t(1) << 32;
+
 public:
-    BinaryFileDiffer(const std::string & filename, const LoadMode & mode, std::optional<size_t> precision, Logger & logger);
+    BinaryFileDiffer(const std::string & filename, const LoadMode & mode, const DiffOptions & options, Logger & logger);
     bool LoadData() override;
-    std::optional<DataDifference> Diff(const FileDiffer & other) const override;
+    bool Diff(const FileDiffer & other, DeltaSink & sink) const override;
+    /// Loaded bytes of the file
+    const std::vector<char> & Bytes() const { return data; }
 
 private:
     DataContext generateContext(size_t offset) const override;
+    /// Return user-presentable hexadecimal representation of a byte, such as 0x25.
+    /// The view is valid for the whole run of the program.
+    static std::string_view displayByte(char byte);
+    /// Split both files into content-defined chunks, diff the chunks, and refine only the parts
+    /// of the files, that are covered by differing chunks, byte by byte.
+    ///
+    /// \param rhs Destination file
+    /// \param sink Sink that receives the difference
+    void diffByChunks(const BinaryFileDiffer & rhs, DeltaSink & sink) const;
+    /// Find byte edit script of parts of the files, and add it to hunks.
+    ///
+    /// \param rhs Destination file
+    /// \param srcFrom First byte of the source part
+    /// \param srcTo One past the last byte of the source part
+    /// \param dstFrom First byte of the destination part
+    /// \param dstTo One past the last byte of the destination part
+    /// \param hunks Builder of hunks of the difference
+    void refine(const BinaryFileDiffer & rhs, size_t srcFrom, size_t srcTo, size_t dstFrom, size_t dstTo, HunkBuilder & hunks) const;
 };
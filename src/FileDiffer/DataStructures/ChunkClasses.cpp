@@ -0,0 +1,51 @@
+#include "ChunkClasses.h"
+
+#include <stdexcept>
+
+ChunkClasses::ChunkClasses(const std::vector<uint64_t> & sourceHashes, const std::vector<uint64_t> & destinationHashes,
+                           const std::function<bool(size_t, size_t)> & sameChunks) {
+    if (sourceHashes.size() + destinationHashes.size() >= empty)
+        throw std::length_error("Too many chunks to number them.");
+
+    // Both files usually share most of their chunks, so there are about as many classes, as chunks
+    // of one file. The table is kept at most half full.
+    size_t size = 16;
+    while (size < sourceHashes.size() + destinationHashes.size()) size *= 2;
+    table.assign(size, Slot{0, empty, 0});
+
+    source.reserve(sourceHashes.size());
+    for (size_t i = 0; i < sourceHashes.size(); ++i)
+        source.push_back(classify(sourceHashes[i], i, sameChunks));
+    destination.reserve(destinationHashes.size());
+    for (size_t i = 0; i < destinationHashes.size(); ++i)
+        destination.push_back(classify(destinationHashes[i], sourceHashes.size() + i, sameChunks));
+}
+
+uint32_t ChunkClasses::classify(uint64_t hash, size_t index, const std::function<bool(size_t, size_t)> & sameChunks) {
+    size_t mask = table.size() - 1;
+    // Hashes are uniformly distributed, so the low bits are used as they are, with linear probing
+    for (size_t slot = hash & mask; ; slot = (slot + 1) & mask) {
+        Slot & entry = table[slot];
+        if (entry.chunkClass == empty) {
+            entry = Slot{hash, classCount, (uint32_t)index};
+            if (++classCount * 2 > table.size()) grow();
+            return classCount - 1;
+        }
+        if (entry.hash != hash) continue;
+        if (!sameChunks || sameChunks(entry.representative, index)) return entry.chunkClass;
+        // Different chunk with the same hash, it gets its own slot further on
+        collisions++;
+    }
+}
+
+void ChunkClasses::grow() {
+    std::vector<Slot> previous(table.size() * 2, Slot{0, empty, 0});
+    previous.swap(table);
+    size_t mask = table.size() - 1;
+    for (const Slot & entry : previous) {
+        if (entry.chunkClass == empty) continue;
+        size_t slot = entry.hash & mask;
+        while (table[slot].chunkClass != empty) slot = (slot + 1) & mask;
+        table[slot] = entry;
+    }
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+/// Numbers chunks of two files (usually lines), so that chunks that are the same get the same
+/// number - their class - and different chunks get different ones.
+///
+/// Chunks are recognized by their 64-bit hashes, but classes are dense 32-bit numbers,
+/// so the diffing algorithms (and their vectorized kernels) compare them the same way,
+/// as 32-bit hashes, just without any chance of two different chunks comparing equal,
+/// unless their 64-bit hashes collide. Even that is ruled out, if chunks with equal hashes
+/// are verified by comparing the chunks themselves.
+class ChunkClasses {
+public:
+    /// Class of each chunk of the source file
+    std::vector<uint32_t> source;
+    /// Class of each chunk of the destination file
+    std::vector<uint32_t> destination;
+    /// Count of chunks, whose hash matched hash of a different chunk
+    size_t collisions = 0;
+
+    /// Number chunks of both files by their hashes.
+    ///
+    /// \param sourceHashes 64-bit hash of each chunk of the source file
+    /// \param destinationHashes 64-bit hash of each chunk of the destination file
+    /// \param sameChunks If set, chunks with equal hashes get the same class only if this returns true for them.
+    /// Chunks are passed by index, source chunks first, followed by destination chunks (destination chunk `i`
+    /// has index `sourceHashes.size() + i`).
+    ChunkClasses(const std::vector<uint64_t> & sourceHashes, const std::vector<uint64_t> & destinationHashes,
+                 const std::function<bool(size_t, size_t)> & sameChunks = {});
+
+private:
+    /// Slot of open addressing table of classes
+    struct Slot {
+        uint64_t hash;
+        /// Class, or [empty]
+        uint32_t chunkClass;
+        /// Index of the first chunk of the class, see [sameChunks]
+        uint32_t representative;
+    };
+    static constexpr uint32_t empty = UINT32_MAX;
+
+    std::vector<Slot> table;
+    /// Count of classes found so far
+    uint32_t classCount = 0;
+
+    /// Find class of the chunk, or start a new one.
+    uint32_t classify(uint64_t hash, size_t index, const std::function<bool(size_t, size_t)> & sameChunks);
+    /// Double size of the table.
+    void grow();
+};
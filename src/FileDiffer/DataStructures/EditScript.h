@@ -0,0 +1,20 @@
+#pragma once
+
+#include <vector>
+
+/// One step of an edit script. Edit script is a sequence of steps,
+/// that transforms chunks of source file into chunks of destination file,
+/// going from the start of both files.
+enum class EditOperation : unsigned char {
+    /// Chunk is the same in both files, move to the next one in both of them
+    Keep,
+    /// Source chunk was replaced by destination chunk
+    Modify,
+    /// Destination chunk was added
+    Add,
+    /// Source chunk was deleted
+    Delete,
+};
+
+/// Sequence of edit operations, ordered from the start of the files.
+typedef std::vector<EditOperation> EditScript;
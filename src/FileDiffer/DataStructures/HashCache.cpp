@@ -0,0 +1,132 @@
+#include "HashCache.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+bool HashCache::Key::operator<(const Key & rhs) const {
+    if (device != rhs.device) return device < rhs.device;
+    if (inode != rhs.inode) return inode < rhs.inode;
+    if (size != rhs.size) return size < rhs.size;
+    return modifiedNs < rhs.modifiedNs;
+}
+
+bool HashCache::Key::operator==(const Key & rhs) const {
+    return device == rhs.device && inode == rhs.inode && size == rhs.size && modifiedNs == rhs.modifiedNs;
+}
+
+HashCache::HashCache(std::string filename) : filename(std::move(filename)) {
+    int fd = open(this->filename.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return;
+
+    struct stat info{};
+    if (fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && (size_t)info.st_size >= sizeof(Header)) {
+        void * map = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        if (map != MAP_FAILED) {
+            mapping = map;
+            mappingLength = (size_t)info.st_size;
+        }
+    }
+    close(fd);
+    if (mapping == nullptr) return;
+
+    Header header{};
+    memcpy(&header, mapping, sizeof(header));
+    // Cache of other version, or truncated by a crash, is ignored
+    if (memcmp(header.magic, magic, sizeof(magic)) != 0 || header.version != version
+        || header.count != (mappingLength - sizeof(Header)) / sizeof(Record)
+        || (mappingLength - sizeof(Header)) % sizeof(Record) != 0)
+        return;
+    // Records are looked up at random, read ahead would read pages never used
+    madvise(mapping, mappingLength, MADV_RANDOM);
+    records = (const Record *)((const char *)mapping + sizeof(Header));
+    recordCount = header.count;
+}
+
+HashCache::~HashCache() {
+    if (mapping != nullptr) munmap(mapping, mappingLength);
+}
+
+HashCache::Key HashCache::KeyOf(const struct stat & info) {
+    Key key;
+    key.device = info.st_dev;
+    key.inode = info.st_ino;
+    key.size = info.st_size;
+    key.modifiedNs = (int64_t)info.st_mtim.tv_sec * 1'000'000'000 + info.st_mtim.tv_nsec;
+    return key;
+}
+
+std::optional<Utility::u64> HashCache::Find(const Key & key) const {
+    const Record * end = records + recordCount;
+    const Record * found = std::lower_bound(records, end, key, [](const Record & record, const Key & key) { return record.key < key; });
+    if (found == end || !(found->key == key)) return {};
+    return found->hash;
+}
+
+void HashCache::Insert(const Key & key, Utility::u64 hash) {
+    timespec now{};
+    clock_gettime(CLOCK_REALTIME, &now);
+    if ((int64_t)now.tv_sec * 1'000'000'000 + now.tv_nsec - key.modifiedNs < racyWindowNs) return;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    added.push_back({key, hash});
+}
+
+size_t HashCache::AddedCount() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return added.size();
+}
+
+bool HashCache::Save(std::string & error) {
+    std::vector<Record> merged;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        merged = added;
+    }
+    merged.insert(merged.end(), records, records + recordCount);
+    // New records precede the old ones of the same file, so they are the ones kept
+    std::stable_sort(merged.begin(), merged.end(), [](const Record & lhs, const Record & rhs) {
+        return lhs.key.device != rhs.key.device ? lhs.key.device < rhs.key.device : lhs.key.inode < rhs.key.inode;
+    });
+    merged.erase(std::unique(merged.begin(), merged.end(), [](const Record & lhs, const Record & rhs) {
+        return lhs.key.device == rhs.key.device && lhs.key.inode == rhs.key.inode;
+    }), merged.end());
+
+    Header header{};
+    memcpy(header.magic, magic, sizeof(magic));
+    header.version = version;
+    header.count = merged.size();
+
+    // Written aside and renamed over the cache, which stays mapped (and valid) until then
+    std::string temporary = filename + ".tmp" + std::to_string(getpid());
+    int fd = open(temporary.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        error = "cannot create \"" + temporary + "\": " + std::strerror(errno);
+        return false;
+    }
+    auto writeAll = [fd](const void * data, size_t length) {
+        const char * position = (const char *)data;
+        while (length > 0) {
+            ssize_t written = write(fd, position, length);
+            if (written < 0 && errno == EINTR) continue;
+            if (written < 0) return false;
+            position += written;
+            length -= (size_t)written;
+        }
+        return true;
+    };
+    bool ok = writeAll(&header, sizeof(header)) && writeAll(merged.data(), merged.size() * sizeof(Record));
+    if (close(fd) != 0) ok = false;
+    if (ok && rename(temporary.c_str(), filename.c_str()) != 0) ok = false;
+    if (!ok) {
+        error = "cannot write \"" + filename + "\": " + std::strerror(errno);
+        unlink(temporary.c_str());
+        return false;
+    }
+    return true;
+}
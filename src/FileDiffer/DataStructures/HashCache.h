@@ -0,0 +1,98 @@
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+#include <sys/stat.h>
+
+#include "../../Utility.cpp"
+
+/// Persistent cache of hashes of file contents, so files not changed since they were
+/// hashed last time are not read again.
+///
+/// Files are identified by device, inode, size and modification time in nanoseconds, all of them
+/// known from one stat call. The cache file is a small header followed by fixed-size records sorted
+/// by the identification. It is mapped to memory and binary searched, so opening even a cache of
+/// millions of files reads nothing but the pages that are looked up.
+///
+/// The file is in native byte order, it describes files of one machine anyway.
+class HashCache {
+public:
+    /// Identification of one version of a file
+    struct Key {
+        Utility::u64 device = 0;
+        Utility::u64 inode = 0;
+        Utility::u64 size = 0;
+        int64_t modifiedNs = 0;
+
+        bool operator<(const Key & rhs) const;
+        bool operator==(const Key & rhs) const;
+    };
+
+private:
+    /// One record of the cache file, as stored in it
+    struct Record {
+        Key key;
+        Utility::u64 hash;
+    };
+    /// Header of the cache file, followed by [count] records
+    struct Header {
+        char magic[4];
+        uint32_t version;
+        Utility::u64 count;
+    };
+    static constexpr char magic[4] = {'D', 'F', 'K', 'C'};
+    static constexpr uint32_t version = 1;
+    /// Files modified less than this before being hashed are not cached. Their timestamp might
+    /// not change, if they are modified again within the granularity of the filesystem clock.
+    static constexpr int64_t racyWindowNs = 2'000'000'000;
+
+    std::string filename;
+    /// Mapping of the cache file, if it exists and is valid
+    void * mapping = nullptr;
+    size_t mappingLength = 0;
+    /// Records of the mapped cache file, sorted by key
+    const Record * records = nullptr;
+    size_t recordCount = 0;
+    /// Records of files hashed in this run, guarded by [mutex]
+    std::vector<Record> added;
+    std::mutex mutex;
+
+public:
+    /// Open cache stored in given file. If the file does not exist, or is not a valid cache,
+    /// the cache is empty (and the file is replaced by Save).
+    ///
+    /// \param filename Filename of the cache file
+    explicit HashCache(std::string filename);
+    ~HashCache();
+    HashCache(const HashCache &) = delete;
+    HashCache & operator=(const HashCache &) = delete;
+
+    /// Key of the file, that the given stat info describes.
+    static Key KeyOf(const struct stat & info);
+
+    /// Find hash of file stored in the cache file. Safe to call concurrently.
+    ///
+    /// \param key Identification of the file
+    /// \return The hash, if the file was hashed before, and has not changed since.
+    std::optional<Utility::u64> Find(const Key & key) const;
+
+    /// Remember hash of a file, to be stored by Save. Safe to call concurrently.
+    ///
+    /// \param key Identification of the file, before it was read
+    /// \param hash Hash of the file contents
+    void Insert(const Key & key, Utility::u64 hash);
+
+    /// Count of files remembered by Insert since the cache was opened
+    size_t AddedCount();
+
+    /// Merge records remembered by Insert with the ones of the cache file, and replace the file.
+    /// Each file (device and inode) keeps only its newest record. The file is replaced atomically,
+    /// so concurrent runs never see partially written cache.
+    ///
+    /// \param error Set to description of the problem, if saving fails
+    /// \return Whether the cache was saved
+    bool Save(std::string & error);
+};
@@ -1,42 +1,81 @@
 #include "LevenshteinMatrix.h"
 
+#include <stdexcept>
+#include <algorithm>
+#include <cstdlib>
+
 LevenshteinMatrix::LevenshteinMatrix(size_t rows, size_t cols, std::optional<size_t> precision) : rows(rows), cols(cols) {
     if (precision.has_value()) this->precision = *precision;
     else this->precision = (rows + cols) / 25;
-}
 
-std::optional<size_t> LevenshteinMatrix::Get(size_t row, size_t col) const {
-    if (isOutsidePrecisionRange(row, col)) return {};
-    if (values.find(getCoord(row, col)) == values.end()) return {};
-    return values.at(getCoord(row, col));
-}
+    // Any value in the matrix is a cost of some path from the top-left corner, it can never exceed this.
+    size_t maximumValue = rows + cols;
+    if (maximumValue >= std::numeric_limits<wide_cell>::max())
+        throw std::length_error("Cannot construct levenshtein matrix: inputs are too large.");
+    narrow = maximumValue < std::numeric_limits<narrow_cell>::max();
 
-LevenshteinMatrix & LevenshteinMatrix::Set(size_t row, size_t col, size_t value) {
-    if (!isOutsidePrecisionRange(row, col))
-        values[getCoord(row, col)] = value;
-    return *this;
-}
+    // Determine band of each row. Columns 0 and rows-1 are stored separately.
+    bandBegin.resize(cols);
+    bandEnd.resize(cols);
+    rowOffset.resize(cols);
+    size_t lastInnerColumn = rows > 1 ? rows - 1 : 1;
+    size_t cellCount = 0;
+    for (size_t row = 0; row < cols; ++row) {
+        size_t begin = 1, end = lastInnerColumn;
+        if (this->precision != 0 && row != 0 && row != cols - 1) {
+            // Column of the main diagonalle at this row, and the first column whose diagonalle row
+            // is within precision range. Integer equivalents of the diagonalle slope.
+            size_t maxCol = row * rows / cols + this->precision;
+            if (maxCol + 1 < end) end = maxCol + 1;
+            if (row > this->precision) {
+                size_t minCol = ((row - this->precision) * rows + cols - 1) / cols;
+                if (minCol > begin) begin = minCol;
+            }
+            if (begin > end) begin = end;
+        }
+        bandBegin[row] = begin;
+        bandEnd[row] = end;
+        rowOffset[row] = cellCount;
+        cellCount += end - begin;
+    }
+    firstColumnOffset = cellCount;
+    lastColumnOffset = cellCount + cols;
+    cellCount += 2 * cols;
 
-size_t LevenshteinMatrix::getCoord(size_t row, size_t col) const {
-    return cols * col + row;
+    if (narrow) narrowCells.assign(cellCount, std::numeric_limits<narrow_cell>::max());
+    else wideCells.assign(cellCount, std::numeric_limits<wide_cell>::max());
 }
 
-bool LevenshteinMatrix::isOutsidePrecisionRange(size_t row, size_t col) const {
-    if (precision == 0) return false;
-
-    if (row == 0 || col == 0) return false;
-    if (row == cols-1 || col == rows-1) return false;
-
-    size_t rowOfDiagonalItemAtGivenCol = (size_t)(((double)col / (double)rows) * (double)cols);
-    size_t colOfDiagonalItemAtGivenRow = (size_t)(((double)row / (double)cols) * (double)rows);
+size_t LevenshteinMatrix::OutsideLowerBound() const {
+    size_t bound = std::numeric_limits<size_t>::max();
+    if (cols < 3 || rows < 3) return bound;
 
-    if (row > precision && row - precision > rowOfDiagonalItemAtGivenCol)
-        return true;
+    // Row coordinate goes through the source (cols), column coordinate through the destination (rows).
+    // Cost of a path through diagonal d = col - row is at least |d| + |endDiagonal - d|,
+    // which is lowest (and equal to |endDiagonal|) between diagonal 0 and endDiagonal.
+    const long long endDiagonal = (long long)rows - (long long)cols;
+    const long long lowest = std::min(0LL, endDiagonal), highest = std::max(0LL, endDiagonal);
+    auto costOfColumns = [&](size_t row, size_t fromCol, size_t toCol) -> size_t {
+        long long fromDiagonal = (long long)fromCol - (long long)row, toDiagonal = (long long)toCol - (long long)row;
+        long long diagonal;
+        if (toDiagonal < lowest) diagonal = toDiagonal;
+        else if (fromDiagonal > highest) diagonal = fromDiagonal;
+        else return (size_t)(highest - lowest);
+        return (size_t)(std::llabs(diagonal) + std::llabs(endDiagonal - diagonal));
+    };
 
-    if (col > precision && col - precision > colOfDiagonalItemAtGivenRow)
-        return true;
+    // First and last row and column are never outside of precision range
+    for (size_t row = 1; row < cols - 1; ++row) {
+        if (bandBegin[row] > 1)
+            bound = std::min(bound, costOfColumns(row, 1, bandBegin[row] - 1));
+        if (bandEnd[row] < rows - 1)
+            bound = std::min(bound, costOfColumns(row, bandEnd[row], rows - 2));
+    }
+    return bound;
+}
 
-    return false;
+bool LevenshteinMatrix::isOutsidePrecisionRange(size_t row, size_t col) const {
+    return getCoord(row, col) == outside;
 }
 
 std::ostream & operator<<(std::ostream & stream, const LevenshteinMatrix & matrix) {
@@ -1,11 +1,13 @@
 #pragma once
 
-#include <unordered_map>
 #include <cstddef>
+#include <cstdint>
+#include <limits>
 #include <ostream>
 #include <iostream>
 #include <iomanip>
 #include <optional>
+#include <vector>
 
 /// Represents levenshtein matrix, which describes edit distance
 /// between two data sets.
@@ -19,11 +21,33 @@
 /// precision, just less efficient. In other words,
 /// the resulting patch(file) will still be correct,
 /// but may be bigger.
+///
+/// Only the diagonal band (and the matrix edges) is stored.
+/// Each row keeps one contiguous range of cells, all rows
+/// share one allocation. Cells are as narrow as the size
+/// of the input allows (edit distance can never exceed
+/// the length of the longer input).
 class LevenshteinMatrix {
-    /// Levenshtein matrix values, mapping key: see [getCoords]
-    std::unordered_map<size_t, size_t> values;
+    /// Narrow cell type, used when both inputs are shorter than its maximum
+    typedef uint16_t narrow_cell;
+    /// Wide cell type, used otherwise
+    typedef uint32_t wide_cell;
+
     /// Rows, cols and set precision of the matrix
     size_t rows, cols, precision;
+    /// Whether cells are stored in [narrowCells] or in [wideCells]
+    bool narrow;
+    /// Band of each row, as half-open range of columns <bandBegin; bandEnd).
+    /// First and last column are not part of the band, they are stored separately.
+    std::vector<size_t> bandBegin, bandEnd;
+    /// Offset of first band cell of each row in the cell storage.
+    /// The first and last column are stored after all the bands.
+    std::vector<size_t> rowOffset;
+    /// Offset of first and last column in the cell storage.
+    size_t firstColumnOffset, lastColumnOffset;
+    /// Cell values, only one of these is allocated. Unset cells contain maximum of the type.
+    std::vector<narrow_cell> narrowCells;
+    std::vector<wide_cell> wideCells;
 
 public:
     /// Construct new levenshtein matrix
@@ -38,17 +62,68 @@ public:
     /// occur.
     LevenshteinMatrix(size_t rows, size_t cols, std::optional<size_t> precision);
 
+    /// Returned by [At] for cells without value
+    static constexpr size_t unset = std::numeric_limits<size_t>::max();
+
+    /// Return value stored in matrix, or [unset], if there is none on given coords
+    /// or they are outside of precision range.
+    size_t At(size_t row, size_t col) const {
+        size_t idx = getCoord(row, col);
+        if (idx == outside) return unset;
+        if (narrow) return narrowCells[idx] == std::numeric_limits<narrow_cell>::max() ? unset : narrowCells[idx];
+        return wideCells[idx] == std::numeric_limits<wide_cell>::max() ? unset : wideCells[idx];
+    }
     /// Return value stored if matrix, if there is any on given coords already
     /// and is within precision range.
-    std::optional<size_t> Get(size_t row, size_t col) const;
+    std::optional<size_t> Get(size_t row, size_t col) const {
+        size_t idx = getCoord(row, col);
+        if (idx == outside) return {};
+        if (narrow) {
+            if (narrowCells[idx] == std::numeric_limits<narrow_cell>::max()) return {};
+            return narrowCells[idx];
+        }
+        if (wideCells[idx] == std::numeric_limits<wide_cell>::max()) return {};
+        return wideCells[idx];
+    }
     /// Set value of the matrix at given coordinates to a value.
     /// This is NOP if the coords are outside precision range.
-    LevenshteinMatrix & Set(size_t row, size_t col, size_t value);
+    LevenshteinMatrix & Set(size_t row, size_t col, size_t value) {
+        size_t idx = getCoord(row, col);
+        if (idx == outside) return *this;
+        if (narrow) narrowCells[idx] = (narrow_cell)value;
+        else wideCells[idx] = (wide_cell)value;
+        return *this;
+    }
+
+    /// First column of the given row that lies within precision range,
+    /// not counting the first and last column, which are always present.
+    size_t BandBegin(size_t row) const { return bandBegin[row]; }
+    /// One past the last column of the given row that lies within precision range,
+    /// not counting the first and last column, which are always present.
+    size_t BandEnd(size_t row) const { return bandEnd[row]; }
+
+    /// Lower bound of cost of any path from top-left to bottom-right corner, that leaves precision range.
+    ///
+    /// A path through a cell k diagonals away from the top-left corner costs at least k, and at least
+    /// its distance to the diagonal of bottom-right corner to finish. If the value in the bottom-right
+    /// corner is not larger than this bound, no cell outside of precision range could improve it,
+    /// and the found edit distance is minimal (see Ukkonen, Algorithms for approximate string matching).
+    ///
+    /// \return The lower bound, or maximum of size_t, if every cell is within precision range.
+    size_t OutsideLowerBound() const;
 
 private:
-    /// Return 1D coordinates, mapped from two of them.
-    /// This allows us to store values in one-dimensional map.
-    size_t getCoord(size_t row, size_t col) const;
+    /// Returned by [getCoord] for coords outside precision range
+    static constexpr size_t outside = std::numeric_limits<size_t>::max();
+
+    /// Return index into cell storage, mapped from two coordinates,
+    /// or [outside], if the coords are outside precision range.
+    size_t getCoord(size_t row, size_t col) const {
+        if (col == 0) return firstColumnOffset + row;
+        if (col == rows - 1) return lastColumnOffset + row;
+        if (col < bandBegin[row] || col >= bandEnd[row]) return outside;
+        return rowOffset[row] + (col - bandBegin[row]);
+    }
     /// Check, if given coords are at least [precision] tiles
     /// away from the main diagonalle, or at the edges of the matrix.
     /// If the given coord is not at one of these positions, it is determined
@@ -60,6 +135,9 @@ private:
     bool isOutsidePrecisionRange(size_t row, size_t col) const;
 
     friend std::ostream & operator<<(std::ostream & stream, const LevenshteinMatrix & matrix);
+    /// Fill rows of the band directly
+    friend class LevenshteinKernel;
+    template<typename T, typename Equal, typename Cost> friend class LevenshteinEngine;
 };
 
 std::ostream & operator<<(std::ostream & stream, const LevenshteinMatrix & matrix);
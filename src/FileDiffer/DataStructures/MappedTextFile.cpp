@@ -0,0 +1,98 @@
+#include "MappedTextFile.h"
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+MappedTextFile::MappedTextFile(MappedTextFile && rhs) noexcept
+        : data(rhs.data), length(rhs.length), mapped(rhs.mapped),
+          buffer(std::move(rhs.buffer)), lineStarts(std::move(rhs.lineStarts)) {
+    // Moving the vector keeps its allocation, so [data] stays valid
+    rhs.data = nullptr;
+    rhs.mapped = false;
+}
+
+MappedTextFile & MappedTextFile::operator=(MappedTextFile && rhs) noexcept {
+    if (this == &rhs) return *this;
+    release();
+    data = rhs.data;
+    length = rhs.length;
+    mapped = rhs.mapped;
+    buffer = std::move(rhs.buffer);
+    lineStarts = std::move(rhs.lineStarts);
+    rhs.data = nullptr;
+    rhs.mapped = false;
+    return *this;
+}
+
+MappedTextFile::~MappedTextFile() {
+    release();
+}
+
+void MappedTextFile::release() {
+    if (mapped) munmap((void *)data, length);
+    mapped = false;
+    data = nullptr;
+}
+
+std::optional<MappedTextFile> MappedTextFile::Load(const std::string & filename) {
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0) return {};
+
+    MappedTextFile result;
+    struct stat info{};
+    bool ok = fstat(fd, &info) == 0;
+    if (ok && S_ISDIR(info.st_mode)) ok = false;
+
+    if (ok && S_ISREG(info.st_mode) && info.st_size > 0) {
+        void * mapping = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping != MAP_FAILED) {
+            // Lines are scanned once from start to end
+            madvise(mapping, (size_t)info.st_size, MADV_SEQUENTIAL);
+            result.data = (const char *)mapping;
+            result.length = (size_t)info.st_size;
+            result.mapped = true;
+        }
+    }
+    // Pipes, FIFOs, special files (size not known upfront), or failed mapping
+    if (ok && !result.mapped) ok = result.readAll(fd);
+
+    close(fd);
+    if (!ok) return {};
+
+    result.indexLines();
+    return result;
+}
+
+bool MappedTextFile::readAll(int fd) {
+    const size_t blockSize = 1 << 16;
+    size_t used = 0;
+    while (true) {
+        buffer.resize(used + blockSize);
+        ssize_t count = read(fd, buffer.data() + used, blockSize);
+        if (count < 0 && errno == EINTR) continue;
+        if (count < 0) return false;
+        if (count == 0) break;
+        used += (size_t)count;
+    }
+    buffer.resize(used);
+    buffer.shrink_to_fit();
+    data = buffer.data();
+    length = used;
+    return true;
+}
+
+void MappedTextFile::indexLines() {
+    lineStarts.clear();
+    lineStarts.push_back(0);
+    const char * position = data;
+    const char * end = data + length;
+    while (position < end) {
+        const auto * newline = (const char *)memchr(position, '\n', end - position);
+        position = newline == nullptr ? end : newline + 1;
+        lineStarts.push_back(position - data);
+    }
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <optional>
+#include <vector>
+
+/// Contents of a text file, split into lines.
+///
+/// Regular files are mapped to memory, so the lines are views into the
+/// page cache and are never copied. Pipes, FIFOs (such as `/dev/stdin`)
+/// and other files that cannot be mapped are read into a buffer instead.
+///
+/// Lines are split the same way as by `std::getline`: on '\n', which is not
+/// part of the line. A trailing newline does not start another line.
+class MappedTextFile {
+    /// Start of the file contents, either mapping or [buffer] data
+    const char * data = nullptr;
+    /// Length of the file contents in bytes
+    size_t length = 0;
+    /// Whether [data] is a mapping, which has to be unmapped
+    bool mapped = false;
+    /// Contents of files that could not be mapped
+    std::vector<char> buffer;
+    /// Offset of start of each line, followed by offset one past the last line
+    std::vector<size_t> lineStarts;
+
+    MappedTextFile() = default;
+
+public:
+    MappedTextFile(const MappedTextFile &) = delete;
+    MappedTextFile & operator=(const MappedTextFile &) = delete;
+    MappedTextFile(MappedTextFile && rhs) noexcept;
+    MappedTextFile & operator=(MappedTextFile && rhs) noexcept;
+    ~MappedTextFile();
+
+    /// Try to load text file, mapping it to memory if possible.
+    ///
+    /// \param filename Filename of the text file
+    /// \return If the file could be opened and read, its contents. Otherwise, nothing.
+    static std::optional<MappedTextFile> Load(const std::string & filename);
+
+    /// Count of lines of the file
+    size_t LineCount() const { return lineStarts.size() - 1; }
+
+    /// View of given line, without the newline. Valid as long as this instance exists.
+    std::string_view Line(size_t idx) const {
+        size_t end = lineStarts[idx + 1];
+        // All lines but possibly the last one are followed by a newline
+        if (end > lineStarts[idx] && data[end - 1] == '\n') end--;
+        return std::string_view(data + lineStarts[idx], end - lineStarts[idx]);
+    }
+
+    /// Whether the file was mapped to memory, or read into a buffer.
+    bool IsMapped() const { return mapped; }
+
+private:
+    /// Read rest of the file from the descriptor to [buffer].
+    ///
+    /// \param fd Open file descriptor
+    /// \return Whether the whole file was read successfully.
+    bool readAll(int fd);
+    /// Find start of each line, scanning for newlines with memchr.
+    void indexLines();
+    /// Unmap the mapping, if there is any.
+    void release();
+};
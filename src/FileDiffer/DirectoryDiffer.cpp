@@ -1,21 +1,283 @@
 #include "DirectoryDiffer.h"
+#include "TextFileDiffer.h"
 
-DirectoryDiffer::DirectoryDiffer(const std::string & dirname, const LoadMode & mode, std::optional<size_t> precision, Logger & logger) : FileDiffer(mode, logger, precision, dirname), rootEntry(dirname, logger) { }
+#include <cerrno>
+#include <cstring>
+#include <deque>
+#include <fcntl.h>
+#include <memory>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <unordered_map>
 
-std::optional<DataDifference> DirectoryDiffer::Diff(const FileDiffer &other) const {
+DirectoryDiffer::DirectoryDiffer(const std::string & dirname, const LoadMode & mode, const DiffOptions & options, Logger & logger) : FileDiffer(mode, logger, options, dirname), rootEntry(dirname, logger) { }
+
+bool DirectoryDiffer::Diff(const FileDiffer &other, DeltaSink &sink) const {
     const auto * directoryRhs = dynamic_cast<const DirectoryDiffer *>(&other);
     if (directoryRhs == nullptr) {
         logger.Log("Cannot compare directory data type (left) with non-directory data type (right). Aborting.", Severity::Critical);
-        return {};
+        return false;
+    }
+    if (options.recursive) {
+        diffRecursively(*directoryRhs, sink);
+        return true;
+    }
+    if (options.detectRenames) {
+        diffByNames(*directoryRhs, sink);
+        return true;
     }
 
-    LevenshteinMatrix matrix = constructLevenshteinMatrix(stringifiedViewHashes, directoryRhs->stringifiedViewHashes);
+    ChunkClasses classes = classifyChunks(stringifiedViewHashes, directoryRhs->stringifiedViewHashes, [this, directoryRhs](size_t lhs, size_t rhs) {
+        // Entries of both directories, source entries first
+        auto entry = [this, directoryRhs](size_t idx) -> const std::string & {
+            return idx < stringifiedView.size() ? stringifiedView[idx] : directoryRhs->stringifiedView[idx - stringifiedView.size()];
+        };
+        return entry(lhs) == entry(rhs);
+    });
+
+    diffChunksInWindows(classes.source, classes.destination, findDifferingSubtrees(*directoryRhs), directoryRhs->filename,
+                        [this](size_t idx) -> std::string_view { return stringifiedView[idx]; },
+                        [directoryRhs](size_t idx) -> std::string_view { return directoryRhs->stringifiedView[idx]; },
+                        sink);
+
+    return true;
+}
 
-    DataDifference result = levenshteinMatrixToDeltas(matrix, stringifiedViewHashes, directoryRhs->stringifiedViewHashes, directoryRhs->filename,
-                                                      [this](size_t idx) -> std::string { return stringifiedView[idx]; },
-                                                      [directoryRhs](size_t idx) -> std::string { return directoryRhs->stringifiedView[idx]; });
+std::vector<DiffWindows::Window> DirectoryDiffer::findDifferingSubtrees(const DirectoryDiffer & other) const {
+    std::vector<DiffWindows::Window> windows;
+    // Lines before these are either equal in both directories, or within one of the windows
+    size_t srcEqualTo = 0, dstEqualTo = 0;
+    auto keepEqual = [&](size_t srcFrom, size_t dstFrom, size_t length) {
+        if (srcFrom != srcEqualTo || dstFrom != dstEqualTo) windows.push_back({srcEqualTo, srcFrom, dstEqualTo, dstFrom});
+        srcEqualTo = srcFrom + length;
+        dstEqualTo = dstFrom + length;
+    };
+    auto sameSubtree = [&](const DirectoryDifferFilesystemEntry & source, const DirectoryDifferFilesystemEntry & destination) {
+        if (source.subtreeHash != destination.subtreeHash || source.viewLength != destination.viewLength) return false;
+        if (!options.verifyHashes) return true;
+        return std::equal(stringifiedView.begin() + source.viewFrom, stringifiedView.begin() + source.viewFrom + source.viewLength,
+                          other.stringifiedView.begin() + destination.viewFrom);
+    };
+
+    // Both entries are on the same path, so their lines are in the same order in both directories
+    std::function<void(const DirectoryDifferFilesystemEntry &, const DirectoryDifferFilesystemEntry &)> align =
+            [&](const DirectoryDifferFilesystemEntry & source, const DirectoryDifferFilesystemEntry & destination) {
+        if (sameSubtree(source, destination)) {
+            keepEqual(source.viewFrom, destination.viewFrom, source.viewLength);
+            return;
+        }
+        // File that changed, or a file replaced by a directory, differs as a whole
+        if (!source.displayAsDirectory || !destination.displayAsDirectory) return;
+
+        keepEqual(source.viewFrom, destination.viewFrom, 1);
+        // Contents are in the same order as their lines, so entries of the same name are merged in one pass,
+        // entries in only one of the directories are left to the windows
+        auto srcChild = source.contents.begin();
+        auto dstChild = destination.contents.begin();
+        while (srcChild != source.contents.end() && dstChild != destination.contents.end()) {
+            if (srcChild->first < dstChild->first) ++srcChild;
+            else if (dstChild->first < srcChild->first) ++dstChild;
+            else align((srcChild++)->second, (dstChild++)->second);
+        }
+    };
+    align(rootEntry, other.rootEntry);
+    keepEqual(stringifiedView.size(), other.stringifiedView.size(), 0);
+
+    logger.Log("Directories differ in " + std::to_string(windows.size()) + " subtree window(s).", Severity::Debug);
+    return windows;
+}
 
-    return result;
+ForcedOutput DirectoryDiffer::OutputStyle() const {
+    return options.detectRenames && !options.recursive ? ForcedOutput::DirectPrint : ForcedOutput::Default;
+}
+
+std::vector<DirectoryDiffer::EntryChange> DirectoryDiffer::joinByNames(const DirectoryDiffer & other, bool pairRenames) const {
+    std::vector<EntryChange> changes;
+    std::function<void(const DirectoryDifferFilesystemEntry &, const DirectoryDifferFilesystemEntry &)> join =
+            [&](const DirectoryDifferFilesystemEntry & source, const DirectoryDifferFilesystemEntry & destination) {
+        if (source.subtreeHash == destination.subtreeHash && source.viewLength == destination.viewLength) return;
+        if (!source.displayAsDirectory || !destination.displayAsDirectory) {
+            if (source.displayAsDirectory == destination.displayAsDirectory) {
+                changes.push_back({DataDeltaKind::Modification, &source, &destination});
+            } else {
+                changes.push_back({DataDeltaKind::Deletion, &source, nullptr});
+                changes.push_back({DataDeltaKind::Addition, nullptr, &destination});
+            }
+            return;
+        }
+
+        // Both maps are sorted by name, entries of the same name meet in one pass
+        auto srcChild = source.contents.begin();
+        auto dstChild = destination.contents.begin();
+        while (srcChild != source.contents.end() || dstChild != destination.contents.end()) {
+            if (dstChild == destination.contents.end() || (srcChild != source.contents.end() && srcChild->first < dstChild->first))
+                changes.push_back({DataDeltaKind::Deletion, &(srcChild++)->second, nullptr});
+            else if (srcChild == source.contents.end() || dstChild->first < srcChild->first)
+                changes.push_back({DataDeltaKind::Addition, nullptr, &(dstChild++)->second});
+            else
+                join((srcChild++)->second, (dstChild++)->second);
+        }
+    };
+    join(rootEntry, other.rootEntry);
+    if (!pairRenames) return changes;
+
+    // Empty files and directories are all alike, pairing them would report arbitrary renames
+    auto movable = [](const DirectoryDifferFilesystemEntry & entry) {
+        if (entry.displayAsDirectory) return !entry.contents.empty();
+        return entry.regularFile && entry.hashed && entry.cacheKey.size > 0;
+    };
+    // Subtree hash does not depend on the path, so it is equal for moved entries. Deleted entries
+    // wait for added ones in order of paths, so the pairing does not depend on anything else.
+    std::unordered_map<Utility::u64, std::deque<size_t>> deletedByHash;
+    for (size_t i = 0; i < changes.size(); ++i)
+        if (changes[i].kind == DataDeltaKind::Deletion && movable(*changes[i].source))
+            deletedByHash[changes[i].source->subtreeHash].push_back(i);
+    if (deletedByHash.empty()) return changes;
+
+    std::vector<bool> pairedAddition(changes.size(), false);
+    for (size_t i = 0; i < changes.size(); ++i) {
+        if (changes[i].kind != DataDeltaKind::Addition || !movable(*changes[i].destination)) continue;
+        auto deleted = deletedByHash.find(changes[i].destination->subtreeHash);
+        if (deleted == deletedByHash.end() || deleted->second.empty()) continue;
+        EntryChange & rename = changes[deleted->second.front()];
+        deleted->second.pop_front();
+        rename.kind = DataDeltaKind::Modification;
+        rename.destination = changes[i].destination;
+        rename.renamed = true;
+        pairedAddition[i] = true;
+    }
+    size_t kept = 0;
+    for (size_t i = 0; i < changes.size(); ++i)
+        if (!pairedAddition[i]) changes[kept++] = changes[i];
+    changes.resize(kept);
+    return changes;
+}
+
+void DirectoryDiffer::diffByNames(const DirectoryDiffer & other, DeltaSink & sink) const {
+    DataDifference difference(filename, other.filename, {}, ForcedOutput::DirectPrint);
+    sink.Begin(difference);
+
+    size_t renamed = 0;
+    std::vector<EntryChange> changes = joinByNames(other, true);
+    for (const auto & change : changes) {
+        std::string label, line;
+        if (change.renamed) {
+            // Moved entries changed their directory, renamed ones only their name
+            bool moved = change.source->path.lexically_relative(rootEntry.path).parent_path()
+                         != change.destination->path.lexically_relative(other.rootEntry.path).parent_path();
+            label = moved ? "moved" : "renamed";
+            line = relativePath(*change.source) + " -> " + other.relativePath(*change.destination);
+            renamed++;
+        } else if (change.kind == DataDeltaKind::Addition) {
+            label = "added";
+            line = other.relativePath(*change.destination);
+        } else {
+            label = change.kind == DataDeltaKind::Deletion ? "deleted" : "modified";
+            line = relativePath(*change.source);
+        }
+        label.resize(9, ' ');
+
+        size_t srcFrom = change.source ? change.source->viewFrom : 0, srcLength = change.source ? change.source->viewLength : 0;
+        size_t dstFrom = change.destination ? change.destination->viewFrom : 0, dstLength = change.destination ? change.destination->viewLength : 0;
+        sink.Delta(difference, DataDelta(change.kind, {label + line + "\n"}, {}, srcFrom, dstFrom, srcLength, dstLength));
+    }
+
+    logger.Log("Directories differ in " + std::to_string(changes.size()) + " entries, " + std::to_string(renamed)
+               + " of them moved or renamed.", Severity::Debug);
+    sink.End(difference);
+}
+
+void DirectoryDiffer::diffRecursively(const DirectoryDiffer & other, DeltaSink & sink) const {
+    // Files to diff, a missing file is /dev/null
+    struct FilePair {
+        std::string source, destination;
+        /// Name the missing file would have in its directory, see DataDifference::missingName
+        std::string missing;
+    };
+    std::vector<FilePair> pairs;
+    std::function<void(const DirectoryDifferFilesystemEntry &, bool)> addWhole = [&](const DirectoryDifferFilesystemEntry & entry, bool deleted) {
+        if (entry.regularFile) {
+            if (deleted) pairs.push_back({entry.path.generic_string(), "/dev/null",
+                                          (other.rootEntry.path / relativePath(entry)).generic_string()});
+            else pairs.push_back({"/dev/null", entry.path.generic_string(),
+                                  (rootEntry.path / other.relativePath(entry)).generic_string()});
+        }
+        for (const auto & child : entry.contents) addWhole(child.second, deleted);
+    };
+    // Git rename headers name the files without the prefix stripped by `patch -p`, which is not known here,
+    // so moved entries are deleted and added instead, and the patch still reproduces the destination
+    if (options.detectRenames) logger.Log("Moved or renamed entries are diffed as deleted and added.", Severity::Info);
+    for (const auto & change : joinByNames(other, false)) {
+        if (change.kind == DataDeltaKind::Deletion) {
+            addWhole(*change.source, true);
+        } else if (change.kind == DataDeltaKind::Addition) {
+            addWhole(*change.destination, false);
+        } else if (change.source->regularFile && change.destination->regularFile) {
+            pairs.push_back({change.source->path.generic_string(), change.destination->path.generic_string(), ""});
+        } else {
+            logger.Log("Skipping \"" + change.source->path.generic_string() + "\", it is not a regular file.", Severity::Debug);
+        }
+    }
+    logger.Log("Diffing contents of " + std::to_string(pairs.size()) + " file(s).", Severity::Debug);
+
+    // Each pair is diffed by one thread, the pool runs as many pairs at once
+    DiffOptions fileOptions = options;
+    fileOptions.jobs = 1;
+    // Either side of an added or deleted file may be empty
+    DiffOptions wholeFileOptions = fileOptions;
+    wholeFileOptions.warnEmptyFiles = false;
+    struct FileDifference {
+        std::unique_ptr<FileDiffer> source, destination;
+        RecordingDeltaSink recorded;
+        bool found = false;
+        /// Added or deleted file, written even without hunks, so empty files are created and removed too
+        bool whole = false;
+    };
+    auto diffPair = [this, &pairs, &fileOptions, &wholeFileOptions](size_t index) {
+        auto result = std::make_unique<FileDifference>();
+        const auto & [sourceName, destinationName, missingName] = pairs[index];
+        bool whole = sourceName == "/dev/null" || destinationName == "/dev/null";
+        // Format is determined by the file that exists, the other one is loaded the same way. Images would be
+        // written as image data, so they are compared as bytes instead.
+        bool sourceExists = sourceName != "/dev/null";
+        const DiffOptions & pairOptions = whole ? wholeFileOptions : fileOptions;
+        std::unique_ptr<FileDiffer> existing = FileDiffer::GetInstance(sourceExists ? sourceName : destinationName, mode, pairOptions, logger);
+        DataFormat format = dynamic_cast<TextFileDiffer *>(existing.get()) != nullptr ? DataFormat::Text : DataFormat::Binary;
+        result->source = FileDiffer::GetInstance(format, sourceName, mode, pairOptions, logger);
+        result->destination = FileDiffer::GetInstance(format, destinationName, mode, pairOptions, logger);
+        if (!result->source->LoadData() || !result->destination->LoadData()) {
+            logger.Log("Failed to load \"" + sourceName + "\" or \"" + destinationName + "\", skipping them.", Severity::Warning);
+            return result;
+        }
+        result->found = result->source->Diff(*result->destination, result->recorded);
+        result->whole = whole;
+        if (DataDifference * recorded = result->recorded.Difference()) recorded->missingName = missingName;
+        return result;
+    };
+
+    ThreadPool pool(options.jobs);
+    // Differences found ahead of the one being passed to the sink are kept in memory, so only a few are found ahead
+    const size_t ahead = 2 * pool.Size();
+    std::vector<std::future<std::unique_ptr<FileDifference>>> differences(pairs.size());
+    auto submit = [&](size_t index) {
+        auto task = std::make_shared<std::packaged_task<std::unique_ptr<FileDifference>()>>([&diffPair, index] { return diffPair(index); });
+        differences[index] = task->get_future();
+        pool.Submit([task] { (*task)(); });
+    };
+    for (size_t i = 0; i < std::min(ahead, pairs.size()); ++i) submit(i);
+    for (size_t i = 0; i < pairs.size(); ++i) {
+        std::unique_ptr<FileDifference> difference = differences[i].get();
+        if (i + ahead < pairs.size()) submit(i + ahead);
+        // Files that differ only in ignored characters (see LoadMode) have no hunks, and are not written at all
+        if (difference->found && (difference->whole || !difference->recorded.Empty())) difference->recorded.Replay(sink);
+    }
+    pool.Wait();
+}
+
+std::string DirectoryDiffer::relativePath(const DirectoryDifferFilesystemEntry & entry) const {
+    std::string path = entry.path.lexically_relative(rootEntry.path).generic_string();
+    if (entry.displayAsDirectory) path += "/";
+    return path;
 }
 
 bool DirectoryDiffer::LoadData() {
@@ -24,13 +286,27 @@ bool DirectoryDiffer::LoadData() {
         return false;
     }
 
+    std::optional<HashCache> cache;
+    if (options.hashCache) cache.emplace(*options.hashCache);
+    HashCache * cachePointer = cache ? &*cache : nullptr;
+
     try {
-        loadDirectory(rootEntry);
+        // Directories are listed and files hashed concurrently, a tree of many small files
+        // is limited by latency of the filesystem otherwise
+        ThreadPool pool(options.jobs);
+        pool.Submit([this, &pool, cachePointer] { loadDirectory(rootEntry, pool, cachePointer); });
+        pool.Wait();
     } catch(const std::filesystem::filesystem_error & fserr) {
         logger.Log("A filesystem error occured while trying to compare filesystem \"" + filename + "\": " + fserr.what(), Severity::Critical);
         return false;
     }
 
+    if (cache && cache->AddedCount() > 0) {
+        logger.Log("Storing hashes of " + std::to_string(cache->AddedCount()) + " file(s) to cache \"" + *options.hashCache + "\".", Severity::Debug);
+        std::string error;
+        if (!cache->Save(error)) logger.Log("Failed to store hash cache: " + error + ".", Severity::Warning);
+    }
+
     // Now, when everything was loaded, convert it to textual form, so we can easily compare it.
     addToStringifiedView(rootEntry);
 
@@ -41,70 +317,96 @@ DataContext DirectoryDiffer::generateContext(size_t offset) const {
     const size_t context_before_len = 4;
     const size_t context_after_len = 2;
 
-    DataContext result;
-
-    result.rawData = Utility::vectorSlice(stringifiedView, (offset - context_before_len > offset) ? 0 : (offset - context_before_len), offset + context_after_len);
-
-    size_t lastBeforeIndexIncl = std::min((offset < context_after_len) ? offset : context_before_len, offset);
-    result.maxIdxOfBeforeContext = lastBeforeIndexIncl;
-    result.maxIdxOfOnContext = result.maxIdxOfBeforeContext + 1; // Assume one line changed
-
-    return result;
+    return DataContext(offset, stringifiedView.size(), context_before_len, context_after_len);
 }
 
-void DirectoryDiffer::loadDirectory(DirectoryDifferFilesystemEntry & directory) {
+void DirectoryDiffer::loadDirectory(DirectoryDifferFilesystemEntry & directory, ThreadPool & pool, HashCache * cache) {
     for (const auto & file : std::filesystem::directory_iterator(directory.path)) {
         std::string filename = file.path().filename().generic_string();
-        directory.contents[filename] = DirectoryDifferFilesystemEntry(file.path(), logger);
-        if (file.is_directory()) loadDirectory(directory.contents.at(filename));
+        // Entries of a map are never moved, so the tasks may keep reference to them
+        DirectoryDifferFilesystemEntry & entry = directory.contents[filename] = DirectoryDifferFilesystemEntry(file.path(), logger, cache);
+        if (file.is_directory()) pool.Submit([this, &entry, &pool, cache] { loadDirectory(entry, pool, cache); });
+        else if (entry.regularFile && !entry.hashed) pool.Submit([this, &entry, cache] { entry.HashContents(logger, cache); });
     }
 }
 
-void DirectoryDiffer::addToStringifiedView(const DirectoryDifferFilesystemEntry &file) {
+void DirectoryDiffer::addToStringifiedView(DirectoryDifferFilesystemEntry &file) {
     // Add to hashes without indent, that one is for user display only.
     std::ostringstream stream;
-    stream << relative(file.path, rootEntry.path).generic_string();
-    if (file.displayAsDirectory) {
-        stream << "/";
-    } else {
-        stream << " (" << Utility::numberToHexString(file.hash) << ")";
+    stream << relativePath(file);
+    if (!file.displayAsDirectory) {
+        stream << " (0x" << std::hex << std::setfill('0') << std::setw(16) << file.hash << ")";
     }
     std::string fileIdentifier = stream.str();
-    Utility::u32 fileIdentifierHash = Utility::Murmur3(fileIdentifier);
+    Utility::u64 fileIdentifierHash = Utility::Hash64(fileIdentifier);
 
+    file.viewFrom = stringifiedView.size();
     stringifiedView.push_back(stream.str());
     stringifiedViewHashes.push_back(fileIdentifierHash);
 
+    // Subtree hash does not depend on the path, only on the names within, so it is equal
+    // for equal subtrees on the same path (the only ones compared) of both directories
+    file.subtreeHash = Utility::Hash64Combine(Utility::Hash64(file.displayAsDirectory ? "/" : ""), file.hash);
     // Print all children, if any
-    for(const auto & child : file.contents) {
+    for(auto & child : file.contents) {
         addToStringifiedView(child.second);
+        file.subtreeHash = Utility::Hash64Combine(Utility::Hash64Combine(file.subtreeHash, Utility::Hash64(child.first)),
+                                                  child.second.subtreeHash);
     }
+    file.viewLength = stringifiedView.size() - file.viewFrom;
 }
 
-DirectoryDifferFilesystemEntry::DirectoryDifferFilesystemEntry(std::filesystem::path path, Logger & logger) : path(std::move(path)) {
-    displayAsDirectory = std::filesystem::is_directory(this->path);
-
-    // If the file is a regular file, compute hash
-    if (std::filesystem::is_regular_file(this->path)) {
-        size_t size = std::filesystem::file_size(this->path);
-        std::ifstream inputStream(this->path, std::ios::binary);
-
-        if (!inputStream) {
-            logger.Log("Failed to read file \"" + this->path.generic_string() + "\", make sure the file exists and is accessible.", Severity::Warning);
-            return;
-        }
+DirectoryDifferFilesystemEntry::DirectoryDifferFilesystemEntry(std::filesystem::path path, Logger & logger, const HashCache * cache) : path(std::move(path)) {
+    // Symbolic links are followed, files that cannot be examined are neither directories nor regular files
+    struct stat info{};
+    if (stat(this->path.c_str(), &info) != 0) return;
+    displayAsDirectory = S_ISDIR(info.st_mode);
+    regularFile = S_ISREG(info.st_mode);
+    if (!regularFile) return;
 
-        size_t sizeToRead = Utility::min<size_t>(size, 4096);
+    cacheKey = HashCache::KeyOf(info);
+    if (cache == nullptr) return;
+    std::optional<Utility::u64> cached = cache->Find(cacheKey);
+    if (cached) {
+        hash = *cached;
+        hashed = true;
+    }
+}
 
-        char buffer[4096];
-        inputStream.read(buffer, sizeToRead);
+void DirectoryDifferFilesystemEntry::HashContents(Logger & logger, HashCache * cache) {
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        logger.Log("Failed to read file \"" + path.generic_string() + "\", make sure the file exists and is accessible.", Severity::Warning);
+        return;
+    }
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
 
-        if (inputStream.fail()) {
-            logger.Log("Failure after reading from file \"" + this->path.generic_string() + "\".", Severity::Warning);
-            return;
+    // One buffer per thread, allocating it per file would cost more than reading most files
+    thread_local std::unique_ptr<char[]> buffer(new char[hashBlockSize]);
+    // Empty file is hashed as no bytes at all
+    Utility::u64 contentHash = Utility::Hash64("", 0);
+    bool endOfFile = false;
+    while (!endOfFile) {
+        // Blocks are always full (but the last one), so the hash does not depend on how much read returns at once
+        size_t blockLength = 0;
+        while (blockLength < hashBlockSize) {
+            ssize_t bytesRead = read(fd, buffer.get() + blockLength, hashBlockSize - blockLength);
+            if (bytesRead < 0 && errno == EINTR) continue;
+            if (bytesRead < 0) {
+                logger.Log("Failure after reading from file \"" + path.generic_string() + "\": " + std::strerror(errno) + ".", Severity::Warning);
+                close(fd);
+                return;
+            }
+            if (bytesRead == 0) {
+                endOfFile = true;
+                break;
+            }
+            blockLength += bytesRead;
         }
-
-        std::vector<char> bytes(buffer, buffer+sizeToRead);
-        hash = Utility::Murmur3(bytes);
+        if (blockLength > 0) contentHash = Utility::Hash64Combine(contentHash, Utility::Hash64(buffer.get(), blockLength));
     }
+    close(fd);
+    hash = contentHash;
+    hashed = true;
+    if (cache != nullptr) cache->Insert(cacheKey, hash);
 }
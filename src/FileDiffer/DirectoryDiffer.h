@@ -5,25 +5,53 @@
 #include <vector>
 
 #include "FileDiffer.h"
+#include "DataStructures/HashCache.h"
 
 /// Represents one file in the filesystem hierarchy.
 class DirectoryDifferFilesystemEntry {
 
 public:
-    /// Hash of the file
-    Utility::u32 hash = 0;
+    /// Size of blocks, in which content of files is read and hashed
+    static constexpr size_t hashBlockSize = 1 << 20;
+
+    /// Hash of the whole content of the file, 0 for anything but regular files. Set by HashContents,
+    /// or found in HashCache.
+    Utility::u64 hash = 0;
+    /// Whether [hash] is known already, without reading the file
+    bool hashed = false;
+    /// Identification of the file in HashCache
+    HashCache::Key cacheKey;
+    /// Hash of the file and of everything within it, built bottom-up from the hashes of the contents.
+    /// Subtrees on the same path with equal hashes have equal string representation.
+    Utility::u64 subtreeHash = 0;
+    /// Index of the first line of the subtree in string representation of the directory
+    size_t viewFrom = 0;
+    /// Count of lines of the subtree in string representation of the directory
+    size_t viewLength = 0;
     /// Path to the file
     std::filesystem::path path;
     /// If the file is a directory, map [name -> file] of it's contents
     std::map<std::string, DirectoryDifferFilesystemEntry> contents;
     /// Whether the file should be displayed to output stream as a directory.
-    bool displayAsDirectory;
+    bool displayAsDirectory = false;
+    /// Whether the file is a regular file, so it's content should be hashed
+    bool regularFile = false;
 
     DirectoryDifferFilesystemEntry() = default;
-    /// Construct new file instance
+    /// Construct new file instance, without reading it's content. Hash of regular file
+    /// is looked up in the cache, if any.
     /// \param path Path to the file
     /// \param logger Logger
-    DirectoryDifferFilesystemEntry(std::filesystem::path path, Logger & logger);
+    /// \param cache Cache of hashes of files not changed since they were hashed, or nullptr
+    DirectoryDifferFilesystemEntry(std::filesystem::path path, Logger & logger, const HashCache * cache = nullptr);
+
+    /// Compute hash of the whole content of the regular file. The content is streamed
+    /// block by block (see hashBlockSize), so files of any size are hashed in constant memory.
+    /// Safe to call for different entries concurrently.
+    ///
+    /// \param logger Logger, warned when the file cannot be read
+    /// \param cache Cache to remember the hash in, or nullptr
+    void HashContents(Logger & logger, HashCache * cache = nullptr);
 };
 
 class DirectoryDiffer : public FileDiffer {
@@ -31,18 +59,74 @@ class DirectoryDiffer : public FileDiffer {
     DirectoryDifferFilesystemEntry rootEntry;
     /// Part of the filesystem that was analysed, dumped into string for easy comparsion
     std::vector<std::string> stringifiedView;
-    /// Hashes of string dump of this part of the filesystem
-    std::vector<Utility::u32> stringifiedViewHashes;
+    /// 64-bit hashes of string dump of this part of the filesystem
+    std::vector<Utility::u64> stringifiedViewHashes;
+
+    /// Change of one entry (with everything within it) between two directories, found by joinByNames
+    struct EntryChange {
+        DataDeltaKind kind;
+        /// Entry in the source directory, nullptr for additions
+        const DirectoryDifferFilesystemEntry * source;
+        /// Entry in the destination directory, nullptr for deletions
+        const DirectoryDifferFilesystemEntry * destination;
+        /// Whether the entry was moved or renamed with it's content unchanged. Such changes are modifications.
+        bool renamed = false;
+    };
 
 public:
-    DirectoryDiffer(const std::string & dirname, const LoadMode & mode, std::optional<size_t> precision, Logger & logger);
+    DirectoryDiffer(const std::string & dirname, const LoadMode & mode, const DiffOptions & options, Logger & logger);
     bool LoadData() override;
-    std::optional<DataDifference> Diff(const FileDiffer & other) const override;
+    bool Diff(const FileDiffer & other, DeltaSink & sink) const override;
+    /// Changes found by names (see DiffOptions::detectRenames) are written as a plain list,
+    /// unless contents of the files are diffed as well
+    ForcedOutput OutputStyle() const override;
 
 private:
     DataContext generateContext(size_t offset) const override;
-    /// Load directory on given path, recursively
-    void loadDirectory(DirectoryDifferFilesystemEntry & file);
-    /// Write string representation of the file into stringifiedView, recursively.
-    void addToStringifiedView(const DirectoryDifferFilesystemEntry & file);
+    /// Load directory on given path, recursively. Subdirectories are loaded, and regular files
+    /// hashed, by tasks submitted to the pool, each of them filling only it's own entry.
+    ///
+    /// \param directory Entry of the directory, it's contents are filled
+    /// \param pool Pool running the tasks
+    /// \param cache Cache of hashes of files, or nullptr
+    void loadDirectory(DirectoryDifferFilesystemEntry & directory, ThreadPool & pool, HashCache * cache);
+    /// Write string representation of the file into stringifiedView, recursively,
+    /// and set the subtree hash and range of lines of the file.
+    void addToStringifiedView(DirectoryDifferFilesystemEntry & file);
+    /// Find parts of string representations of this and the other directory, that have to be diffed.
+    ///
+    /// Both trees are walked from the root, descending only into directories on the same path whose
+    /// subtree hashes differ. Everything else on the same path is either equal in both (and skipped),
+    /// or differs as a whole, so the time depends on the size of the change, not of the directories.
+    ///
+    /// \param other The other (destination) directory
+    /// \return Windows ordered from the start of the representations, see DiffWindows.
+    std::vector<DiffWindows::Window> findDifferingSubtrees(const DirectoryDiffer & other) const;
+    /// Find changed entries of this and the other directory by a merge-join of their sorted contents,
+    /// descending only into directories on the same path whose subtree hashes differ. Deleted and added
+    /// entries of equal subtree hash (and not empty) are paired as renamed, each entry at most once.
+    ///
+    /// \param other The other (destination) directory
+    /// \param pairRenames Whether to pair deleted and added entries as renamed
+    /// \return Changes in order of paths (renames at the path of the source entry).
+    std::vector<EntryChange> joinByNames(const DirectoryDiffer & other, bool pairRenames) const;
+    /// Pass changes found by joinByNames to the sink, one line per change.
+    ///
+    /// \param other The other (destination) directory
+    /// \param sink Sink that receives the difference
+    void diffByNames(const DirectoryDiffer & other, DeltaSink & sink) const;
+    /// Diff contents of each changed regular file by a differ of its format (see FileDiffer::GetInstance),
+    /// and pass the differences to the sink one after another, in order of paths. Files of deleted or added
+    /// entries are diffed against /dev/null, even if they were moved (see DiffOptions::detectRenames), so that
+    /// the patch reproduces the destination directory. The files are diffed concurrently on a pool of DiffOptions::jobs
+    /// threads, at most a few files ahead of the one being passed to the sink.
+    ///
+    /// \param other The other (destination) directory
+    /// \param sink Sink that receives the differences
+    void diffRecursively(const DirectoryDiffer & other, DeltaSink & sink) const;
+    /// Path of the entry relative to the root of its directory, with "/" appended to directories.
+    ///
+    /// \param entry Entry of this directory
+    /// \return The path
+    std::string relativePath(const DirectoryDifferFilesystemEntry & entry) const;
 };
@@ -16,35 +16,35 @@ const std::string textFileExtensions[] = { ".txt", ".md", ".latex", ".tex", ".cp
 const std::string binaryFileExtensions[] = { ".out", ".bin" };
 
 
-std::unique_ptr<FileDiffer> FileDiffer::GetInstance(const std::string & filename, const LoadMode & mode, std::optional<size_t> precision, Logger & logger) {
+std::unique_ptr<FileDiffer> FileDiffer::GetInstance(const std::string & filename, const LoadMode & mode, const DiffOptions & options, Logger & logger) {
     for (const auto & extension : PPMFileExtensions) {
         if (stringEndsWith(filename, extension))
             return std::make_unique<PPMFileDiffer>(filename, mode, logger);
     }
     for (const auto & extension : textFileExtensions) {
         if (stringEndsWith(filename, extension))
-            return std::make_unique<TextFileDiffer>(filename, mode, precision, logger);
+            return std::make_unique<TextFileDiffer>(filename, mode, options, logger);
     }
     for (const auto & extension : binaryFileExtensions) {
         if (stringEndsWith(filename, extension))
-            return std::make_unique<BinaryFileDiffer>(filename, mode, precision, logger);
+            return std::make_unique<BinaryFileDiffer>(filename, mode, options, logger);
     }
     for (const auto & extension : directoryFileExtensions) {
         if (stringEndsWith(filename, extension))
-            return std::make_unique<DirectoryDiffer>(filename, mode, precision, logger);
+            return std::make_unique<DirectoryDiffer>(filename, mode, options, logger);
     }
 
     // Check if it is a directory
     if (std::filesystem::is_directory(filename)) {
         logger.Log("Determined file \"" + filename + "\" to be a directory.", Severity::Info);
-        return std::make_unique<DirectoryDiffer>(filename, mode, precision, logger);
+        return std::make_unique<DirectoryDiffer>(filename, mode, options, logger);
     }
 
     // If we are dealing with stdin, do not read, and compare via text loudly
     if (filename == "/dev/stdin") {
         logger.Log("No format for stdin was set, and we cannot determine it without ruining the stream. Falling back to "
                    "purely textual comparsion. Please specify format explicitly.", Severity::Warning);
-        return std::make_unique<TextFileDiffer>(filename, mode, precision, logger);
+        return std::make_unique<TextFileDiffer>(filename, mode, options, logger);
     }
 
     // Read first 1024 bytes and decide, whether it is binary or text file.
@@ -67,24 +67,24 @@ std::unique_ptr<FileDiffer> FileDiffer::GetInstance(const std::string & filename
         // We can't tell otherwise (b/c unicode)
         if (byteRead < 0x20 && byteRead != 0x0A && byteRead != 0x0D && byteRead != 0x09) {
             logger.Log("Determined file \"" + filename + "\" to be binary, because of byte \" + Utility::byteToHexString(byteRead) + \" at index " + std::to_string(byteCount) + ".", Severity::Info);
-            return std::make_unique<BinaryFileDiffer>(filename, mode, precision, logger);
+            return std::make_unique<BinaryFileDiffer>(filename, mode, options, logger);
         }
     }
 
-    return std::make_unique<TextFileDiffer>(filename, mode, precision, logger);
+    return std::make_unique<TextFileDiffer>(filename, mode, options, logger);
 }
 
-std::unique_ptr<FileDiffer> FileDiffer::GetInstance(DataFormat forcedFormat, const std::string & filename, const LoadMode & mode, std::optional<size_t> precision, Logger & logger) {
-    if (forcedFormat == DataFormat::Automatic) return FileDiffer::GetInstance(filename, mode, precision, logger);
+std::unique_ptr<FileDiffer> FileDiffer::GetInstance(DataFormat forcedFormat, const std::string & filename, const LoadMode & mode, const DiffOptions & options, Logger & logger) {
+    if (forcedFormat == DataFormat::Automatic) return FileDiffer::GetInstance(filename, mode, options, logger);
     switch(forcedFormat) {
        case Binary:
-           return std::make_unique<BinaryFileDiffer>(filename, mode, precision, logger);
+           return std::make_unique<BinaryFileDiffer>(filename, mode, options, logger);
        case Text:
-           return std::make_unique<TextFileDiffer>(filename, mode, precision, logger);
+           return std::make_unique<TextFileDiffer>(filename, mode, options, logger);
        case PPM:
            return std::make_unique<PPMFileDiffer>(filename, mode, logger);
        case Directory:
-           return std::make_unique<DirectoryDiffer>(filename, mode, precision, logger);
+           return std::make_unique<DirectoryDiffer>(filename, mode, options, logger);
         default:
             throw std::invalid_argument("Unknown data format while constructing file loader.");
     }
@@ -101,3 +101,74 @@ LoadMode & operator|= (LoadMode & lhs, const LoadMode & rhs) {
 LoadMode operator&(const LoadMode &lhs, const LoadMode &rhs) {
     return (LoadMode)((int)lhs & (int)rhs);
 }
+
+ChunkClasses FileDiffer::classifyChunks(const std::vector<Utility::u64> & sourceHashes, const std::vector<Utility::u64> & destinationHashes,
+                                        const std::function<bool(size_t, size_t)> & sameChunks) const {
+    if (!options.verifyHashes) return ChunkClasses(sourceHashes, destinationHashes);
+
+    ChunkClasses classes(sourceHashes, destinationHashes, sameChunks);
+    logger.Log("Verified chunks with equal hashes, found " + std::to_string(classes.collisions) + " hash collision(s).", Severity::Debug);
+    return classes;
+}
+
+EditScript FileDiffer::levenshteinMatrixToEditScript(const LevenshteinMatrix & matrix, size_t sourceSize, size_t destinationSize) const {
+    EditScript script;
+    size_t i = sourceSize, j = destinationSize;
+
+    while (i != 0 || j != 0) {
+        // Get neighbours: top, left, topleft. Choose smallest one, preferring topleft and then left.
+        // This will be part of the lowest edit distance. Missing neighbours are unset, larger than any value.
+        size_t leftVal = LevenshteinMatrix::unset, topVal = LevenshteinMatrix::unset, leftTopVal = LevenshteinMatrix::unset;
+
+        if (i != 0) topVal = matrix.At(i - 1, j);
+        if (j != 0) leftVal = matrix.At(i, j - 1);
+        if (i != 0 && j != 0) leftTopVal = matrix.At(i - 1, j - 1);
+
+        size_t minimum = std::min(std::min(leftVal, topVal), leftTopVal);
+
+        if (minimum == leftTopVal && i != 0 && j != 0) /* either no change or modification */ {
+            // If the value did not change, just follow the path for free
+            script.push_back(matrix.At(i, j) == leftTopVal ? EditOperation::Keep : EditOperation::Modify);
+            i--;
+            j--;
+        } else if (minimum == leftVal && j != 0) /* addition */ {
+            script.push_back(EditOperation::Add);
+            j--;
+        } else if (minimum == topVal && i != 0) /* deletion */ {
+            script.push_back(EditOperation::Delete);
+            i--;
+        } else {
+            throw std::logic_error(
+                    "Error while diffing: found a change in diff matrix that doesn't correspond to anything.");
+        }
+    }
+
+    std::reverse(script.begin(), script.end());
+    return script;
+}
+
+void FileDiffer::appendEditScript(const EditScript & script, size_t srcFrom, size_t dstFrom, HunkBuilder & hunks) const {
+    // Index of the next source and destination chunk
+    size_t i = srcFrom, j = dstFrom;
+    for (EditOperation operation : script) {
+        switch (operation) {
+            case EditOperation::Keep:
+                i++;
+                j++;
+                break;
+            case EditOperation::Modify:
+                hunks.Append(DataDeltaKind::Modification, generateContext(i), i + 1, j + 1, 1, 1);
+                i++;
+                j++;
+                break;
+            case EditOperation::Add:
+                hunks.Append(DataDeltaKind::Addition, generateContext(i - 1), i, j + 1, 0, 1);
+                j++;
+                break;
+            case EditOperation::Delete:
+                hunks.Append(DataDeltaKind::Deletion, generateContext(i), i + 1, j, 1, 0);
+                i++;
+                break;
+        }
+    }
+}
@@ -2,8 +2,21 @@
 
 #include "../Logger/Logger.h"
 #include "../DataOutput/DataDifference.h"
+#include "../DataOutput/DeltaSink.h"
+#include "../DataOutput/HunkBuilder.h"
 #include "../Utility.cpp"
 #include "DataStructures/LevenshteinMatrix.h"
+#include "DataStructures/EditScript.h"
+#include "DataStructures/ChunkClasses.h"
+#include "Algorithms/MyersDiff.h"
+#include "Algorithms/HirschbergDiff.h"
+#include "Algorithms/PatienceDiff.h"
+#include "Algorithms/HistogramDiff.h"
+#include "Algorithms/BitParallelDiff.h"
+#include "Algorithms/LevenshteinEngine.h"
+#include "Algorithms/TiledFill.h"
+#include "../ThreadPool.h"
+#include "Algorithms/DiffWindows.h"
 
 #include <fstream>
 #include <iomanip>
@@ -11,6 +24,9 @@
 #include <stdexcept>
 #include <memory>
 #include <optional>
+#include <algorithm>
+#include <type_traits>
+#include <future>
 #include <fstream>
 
 /// File formats that are supported, and may be forced by user.
@@ -52,19 +68,59 @@ LoadMode & operator|=(LoadMode &lhs, const LoadMode &rhs);
 /// \return New enum, that contains variants that are in both the first and second enum.
 LoadMode operator&(const LoadMode & lhs, const LoadMode &rhs);
 
+/// Algorithms that may be used to find difference between chunks of two files.
+enum DiffAlgorithm {
+    /// Levenshtein matrix, limited by precision (see LevenshteinMatrix)
+    Levenshtein,
+    /// Myers O((N+M)D) greedy algorithm, see MyersDiff
+    Myers,
+    /// Exact levenshtein distance in linear space, see HirschbergDiff
+    Hirschberg,
+    /// Anchored on chunks unique in both files, see PatienceDiff
+    Patience,
+    /// Anchored on the least frequent chunks, see HistogramDiff
+    Histogram,
+};
+
+/// Settings of the diffing process, as requested by user.
+struct DiffOptions {
+    /// Precision of the levenshtein matrix. If not set, it is widened until the result is minimal.
+    std::optional<size_t> precision = {};
+    /// Report whether levenshtein matrix found minimal edit distance
+    bool checkOptimality = false;
+    /// Algorithm used to find the edit script between two files
+    DiffAlgorithm algorithm = DiffAlgorithm::Levenshtein;
+    /// Count of threads used to diff windows or fill levenshtein matrix, 0 means one per hardware thread
+    size_t jobs = 1;
+    /// Split files at chunks unique to both of them, and diff the parts independently
+    bool splitAtAnchors = false;
+    /// Compare chunks (lines) themselves, when their hashes are equal
+    bool verifyHashes = false;
+    /// Diff binary files by content-defined chunks first, see BinaryFileDiffer
+    bool contentDefinedChunks = false;
+    /// Filename of persistent cache of hashes of files in directories, see HashCache
+    std::optional<std::string> hashCache = {};
+    /// Compare directories by names of their entries, and report moved entries, see DirectoryDiffer
+    bool detectRenames = false;
+    /// Diff contents of changed files of directories, see DirectoryDiffer
+    bool recursive = false;
+    /// Warn, when no chunks were read from a file. Added or deleted files are diffed against nothing on purpose.
+    bool warnEmptyFiles = true;
+};
+
 /// Generic class that is able to load a file, and later produce diff between itself and another
 /// instance of it's kind.
 class FileDiffer {
 protected:
     const LoadMode &mode;
     Logger &logger;
-    std::optional<size_t> precision;
+    DiffOptions options;
     std::ifstream inputStream;
     const std::string filename;
 
 public:
-    FileDiffer(const LoadMode &mode, Logger &logger, std::optional<size_t> precision, std::string filename) :
-        mode(mode), logger(logger), precision(precision), filename(std::move(filename)) {}
+    FileDiffer(const LoadMode &mode, Logger &logger, DiffOptions options, std::string filename) :
+        mode(mode), logger(logger), options(std::move(options)), filename(std::move(filename)) {}
 
     virtual ~FileDiffer() = default;
 
@@ -72,19 +128,21 @@ public:
     ///
     /// \param filename Target filename
     /// \param mode Specific load mode (permissiveness) forced by user, if any
+    /// \param options Diffing settings requested by user
     /// \param logger logger
     /// \return Instance of one of the subclasses
-    static std::unique_ptr<FileDiffer> GetInstance(const std::string &filename, const LoadMode &mode, std::optional<size_t> precision, Logger &logger);
+    static std::unique_ptr<FileDiffer> GetInstance(const std::string &filename, const LoadMode &mode, const DiffOptions &options, Logger &logger);
 
     /// Get instance of one diffing subclass, as forced by user.
     ///
     /// \param forcedFormat File format that is expected to be in the file. No questions asked. Target subclass will be returned.
     /// \param filename Target filename
     /// \param mode Specific load mode (permissiveness) forced by user, if any
+    /// \param options Diffing settings requested by user
     /// \param logger logger
     /// \return Instance of one of the subclasses forced
     static std::unique_ptr<FileDiffer>
-    GetInstance(DataFormat forcedFormat, const std::string &filename, const LoadMode &mode, std::optional<size_t> precision, Logger &logger);
+    GetInstance(DataFormat forcedFormat, const std::string &filename, const LoadMode &mode, const DiffOptions &options, Logger &logger);
 
     /// Try to load data into memory from the given file. This is a prereq for calling Diff.
     /// Loading progress may be logged into logger, depending on severity.
@@ -92,15 +150,29 @@ public:
     /// \return Whether loading succeeded.
     virtual bool LoadData() = 0;
 
-    /// Create difference between this and other instance. The other instance should be of the same or compatible type,
-    /// otherwise, the result is unspecified. This shall be called after successfully calling `LoadData`, otherwise
-    /// the result is unspecified.
+    /// Create difference between this and other instance, and pass it to the sink hunk by hunk, as soon as each hunk
+    /// is final. The other instance should be of the same or compatible type, otherwise, the result is unspecified.
+    /// This shall be called after successfully calling `LoadData`, otherwise the result is unspecified.
     ///
     /// \param other Other instance. This has to be the same or compatible type. An error will be reported otherwise.
-    /// \return Nothing if an error occurred, or data difference between two files loaded.
-    virtual std::optional<DataDifference> Diff(const FileDiffer &other) const = 0;
+    /// \param sink Sink that receives the data difference between two files loaded.
+    /// \return False if an error occurred before anything was passed to the sink, true otherwise.
+    virtual bool Diff(const FileDiffer &other, DeltaSink &sink) const = 0;
+
+    /// Output style this file format requires, see DataOutput::GetOutput.
+    virtual ForcedOutput OutputStyle() const { return ForcedOutput::Default; }
 
 protected:
+    /// Maximum count of cells of levenshtein matrix with unlimited precision. Larger
+    /// inputs are diffed with HirschbergDiff, which finds the same edit distance in linear space.
+    static constexpr size_t fullMatrixCellLimit = 1 << 27;
+    /// Precision of the first levenshtein matrix, when precision is determined adaptively
+    static constexpr size_t initialAdaptivePrecision = 8;
+    /// Bytes are diffed bit-parallel instead, once the band is wider than this fraction of destination
+    static constexpr size_t bitParallelBandRatio = 1024;
+    /// Levenshtein matrices with fewer cells are always filled by one thread
+    static constexpr size_t parallelFillCellLimit = 1 << 20;
+
     /// Generate context of source file at given offset.
     ///
     /// Context generally contains some of the lines before and
@@ -109,18 +181,32 @@ protected:
     /// used to display the diff itself - for example when modifying,
     /// it is used to display the old value.
     /// \param offset Offset from start of file. Depending on data type, this may be lines, bytes, etc.
-    /// \return DataContext structure around the given offset.
+    /// \return DataContext structure around the given offset, only indexes of the chunks are stored.
     virtual DataContext generateContext(size_t offset) const = 0;
 
+    /// Number chunks of both files by their 64-bit hashes, so they can be diffed as 32-bit classes, see ChunkClasses.
+    ///
+    /// \param sourceHashes Hash of each chunk of source file.
+    /// \param destinationHashes Hash of each chunk of destination file.
+    /// \param sameChunks Function that compares two chunks with equal hash, see ChunkClasses. Used only when
+    /// user requested verification of hashes.
+    /// \return Class of each chunk of both files.
+    ChunkClasses classifyChunks(const std::vector<Utility::u64> & sourceHashes, const std::vector<Utility::u64> & destinationHashes,
+                                const std::function<bool(size_t, size_t)> & sameChunks) const;
+
     /// Construct levenshtein matrix from two vectors of type T.
     ///
     /// The type has to provide `==` operator. The caller is expected to delete [] result themselves.
+    /// Cells are filled by LevenshteinEngine specialized for T. Large matrices are filled
+    /// by TiledFill, when user requested more than one job.
     ///
     /// See more here: https://en.wikipedia.org/wiki/Levenshtein_distance#Iterative_with_full_matrix
     ///
     /// \tparam T The chunk type - typically string (for line) or char (for bytes). Can be even hashes or anything else.
     /// \param source Vector of chunks of source file.
     /// \param destination Vector of chunks of source file.
+    /// \param precision Precision of the matrix, see LevenshteinMatrix.
+    /// \param jobs Count of threads filling the matrix, see DiffOptions.
     /// \return Levenshtein matrix of these two vectors, where each chunk is processed as if it was standalone
     /// letter. Two chunks that compare the same are considered equal, and are represented intuitively
     /// in the matrix, as one would except.
@@ -128,116 +214,239 @@ protected:
     // This has to be implemented in header, bc of templates.
     // The implementation of a non-specialized template must be visible to a translation unit that uses it.
     template<typename T>
-    LevenshteinMatrix constructLevenshteinMatrix(const std::vector<T> &source, const std::vector<T> &destination) const {
+    LevenshteinMatrix constructLevenshteinMatrix(const std::vector<T> &source, const std::vector<T> &destination,
+                                                 std::optional<size_t> precision, size_t jobs) const {
         LevenshteinMatrix matrix(destination.size()+1, source.size()+1, precision);
 
-        // Fill source and target prefix
-        for (size_t i = 0; i <= source.size(); ++i) {
-            matrix.Set(i, 0, i);
-        }
-        for (size_t j = 0; j <= destination.size(); ++j) {
-            matrix.Set(0, j, j);
-        }
-
-        auto increment = [](size_t k) -> size_t { return k + 1; };
-        // Fill rest of the matrix
-        for (size_t i = 1; i <= source.size(); ++i) {
-            for (size_t j = 1; j <= destination.size(); ++j) {
-                size_t modificationCost = (source[i-1] == destination[j-1]) ? 0 : 1;
-
-                matrix.Set(i, j, *Utility::min<std::optional<size_t>>(
-                        Utility::apply<size_t>(matrix.Get(i - 1, j), increment), // Deletion
-                        Utility::apply<size_t>(matrix.Get(i, j - 1), increment), // Addition
-                        Utility::apply<size_t>(matrix.Get(i - 1, j - 1),
-                           [modificationCost](size_t k) { return k + modificationCost; }), // Modification
-                        Utility::cmpOptionals<size_t>)
-                );
-            }
+        size_t middle = source.size() / 2;
+        size_t bandWidth = matrix.BandEnd(middle) > matrix.BandBegin(middle) ? matrix.BandEnd(middle) - matrix.BandBegin(middle) : 0;
+        if (jobs != 1 && source.size() * bandWidth >= parallelFillCellLimit) {
+            // Fill source and target prefix, the rest is filled by multiple threads, tile by tile
+            LevenshteinEngine<T>::FillEdges(matrix, source.size(), destination.size());
+            TiledFill::Run(matrix, source.size(), destination.size(), jobs,
+                           [&](size_t rowFrom, size_t rowTo, size_t colFrom, size_t colTo) {
+                LevenshteinEngine<T>::FillTile(matrix, source, destination, rowFrom, rowTo, colFrom, colTo);
+            });
+            return matrix;
         }
 
+        LevenshteinEngine<T>::Fill(matrix, source, destination);
         return matrix;
     }
 
-    /// Find cheapest path from bottom-right corner of the levenshtein matrix to the top-left corner.
-    /// This also generates the necessary edit sequence, needed to edit the file.
+    /// Find difference between two vectors of chunks, using algorithm requested by user,
+    /// and pass it to the sink, hunk by hunk.
+    ///
+    /// Only parts of the files found by DiffWindows are passed to the algorithm. Windows are split
+    /// at unique chunks only for levenshtein with fixed limited precision, as the other algorithms either
+    /// guarantee minimal edit script, or anchor the diff themselves - unless the user asks for it.
+    /// With more than one job, windows are diffed concurrently. Hunks of a window are passed to the sink
+    /// as soon as the window, and all the windows before it, are diffed, so only edit scripts of windows
+    /// diffed ahead are kept in memory.
     ///
     /// \tparam T The chunk type - typically string (for line) or char (for bytes). Can be even hashes or anything else.
-    /// \param matrix Levenshtein matrix of the source and destination
     /// \param source Vector of chunks of source file.
     /// \param destination Vector of chunks of source file.
     /// \param dstFilename Destination filename, to be written in difference log.
-    /// \param sourceDataDisplayFunction Function that, given size_t index, returns user-presentable information
+    /// \param sourceDataDisplayFunction Function that, given size_t index, returns view of user-presentable information
     /// about the chunk. Might not be the same, as the `source` chunk. (Eg `source` might contain bytes as `vector<char>`,
-    /// while this function might return their textual representation as std::string (eg 0x25 and such)).
-    /// \param destinationDataDisplayFunction Function that, given size_t index, returns user-presentable information
+    /// while this function might return their textual representation (eg 0x25 and such)). The view has to stay valid
+    /// as long as this differ exists, as it is used to materialize context when the difference is written.
+    /// \param destinationDataDisplayFunction Function that, given size_t index, returns view of user-presentable information
     /// about the chunk. Might not be the same, as the `source` chunk. (Eg `source` might contain bytes as `vector<char>`,
-    /// while this function might return their textual representation as std::string (eg 0x25 and such)).
-    /// \return Data difference described by the matrix, with recorded information about context and filenames.
+    /// while this function might return their textual representation (eg 0x25 and such)).
+    /// \param sink Sink that receives the difference between source and destination, with recorded information
+    /// about context and filenames.
+    //
+    // This has to be implemented in header, bc of templates.
+    // The implementation of a non-specialized template must be visible to a translation unit that uses it.
+    template<typename T>
+    void diffChunks(const std::vector<T> &source, const std::vector<T> &destination,
+                    const std::string &dstFilename,
+                    const std::function<std::string_view(size_t idx)>& sourceDataDisplayFunction,
+                    const std::function<std::string_view(size_t idx)>& destinationDataDisplayFunction,
+                    DeltaSink & sink) const {
+        bool splitAtAnchors = options.splitAtAnchors || (options.algorithm == Levenshtein && options.precision.has_value()
+                              && *options.precision != 0 && !options.checkOptimality);
+        diffChunksInWindows(source, destination, DiffWindows::Find(source, destination, splitAtAnchors), dstFilename,
+                            sourceDataDisplayFunction, destinationDataDisplayFunction, sink);
+    }
+
+    /// Find difference between two vectors of chunks, that differ only within given windows, and pass it
+    /// to the sink, hunk by hunk. See diffChunks, which finds the windows by DiffWindows.
+    ///
+    /// \tparam T The chunk type.
+    /// \param source Vector of chunks of source file.
+    /// \param destination Vector of chunks of source file.
+    /// \param windows Windows ordered from the start of the files, that do not overlap. All chunks between them
+    /// have to be equal in both files.
+    /// \param dstFilename Destination filename, to be written in difference log.
+    /// \param sourceDataDisplayFunction See diffChunks.
+    /// \param destinationDataDisplayFunction See diffChunks.
+    /// \param sink Sink that receives the difference between source and destination.
+    //
+    // This has to be implemented in header, bc of templates.
+    template<typename T>
+    void diffChunksInWindows(const std::vector<T> &source, const std::vector<T> &destination,
+                             const std::vector<DiffWindows::Window> & windows, const std::string &dstFilename,
+                             const std::function<std::string_view(size_t idx)>& sourceDataDisplayFunction,
+                             const std::function<std::string_view(size_t idx)>& destinationDataDisplayFunction,
+                             DeltaSink & sink) const {
+        DataDifference difference(filename, dstFilename, {}, ForcedOutput::Default, sourceDataDisplayFunction,
+                                  destinationDataDisplayFunction);
+        sink.Begin(difference);
+        HunkBuilder hunks(sink, difference);
+        size_t edited = 0;
+
+        auto diffWindowAt = [&](size_t index, size_t jobs) {
+            const auto & window = windows[index];
+            return diffWindow(std::vector<T>(source.begin() + window.srcFrom, source.begin() + window.srcTo),
+                              std::vector<T>(destination.begin() + window.dstFrom, destination.begin() + window.dstTo), jobs);
+        };
+        // Everything between windows is the same, so only edit scripts of windows are described
+        auto appendWindow = [&](size_t index, const EditScript & script) {
+            edited += script.size() - std::count(script.begin(), script.end(), EditOperation::Keep);
+            appendEditScript(script, windows[index].srcFrom, windows[index].dstFrom, hunks);
+        };
+        if (options.jobs != 1 && windows.size() > 1) {
+            // Windows are independent, so they are diffed concurrently, each by one thread
+            ThreadPool pool(std::min(options.jobs == 0 ? ThreadPool::HardwareThreads() : options.jobs, windows.size()));
+            // Scripts found ahead of the one being appended are kept in memory, so only a few windows are diffed ahead
+            const size_t ahead = 2 * pool.Size();
+            std::vector<std::future<EditScript>> windowScripts(windows.size());
+            auto submit = [&](size_t index) {
+                auto task = std::make_shared<std::packaged_task<EditScript()>>([&, index] { return diffWindowAt(index, 1); });
+                windowScripts[index] = task->get_future();
+                pool.Submit([task] { (*task)(); });
+            };
+            for (size_t i = 0; i < std::min(ahead, windows.size()); ++i) submit(i);
+            for (size_t i = 0; i < windows.size(); ++i) {
+                EditScript script = windowScripts[i].get();
+                if (i + ahead < windows.size()) submit(i + ahead);
+                appendWindow(i, script);
+            }
+            pool.Wait();
+        } else {
+            for (size_t i = 0; i < windows.size(); ++i) appendWindow(i, diffWindowAt(i, options.jobs));
+        }
+        hunks.Finish();
+
+        logger.Log("Diffed " + std::to_string(windows.size()) + " window(s), covering "
+                   + std::to_string(edited) + " edited chunk(s).", Severity::Debug);
+        sink.End(difference);
+    }
+
+    /// Find edit script between two vectors of chunks, using algorithm requested by user.
+    ///
+    /// \tparam T The chunk type - typically string (for line) or char (for bytes). Can be even hashes or anything else.
+    /// \param source Vector of chunks of source file (or part of it).
+    /// \param destination Vector of chunks of destination file (or part of it).
+    /// \param jobs Count of threads filling levenshtein matrix, see DiffOptions.
+    /// \return Edit script from source to destination.
     //
     // This has to be implemented in header, bc of templates.
     // The implementation of a non-specialized template must be visible to a translation unit that uses it.
     template<typename T>
-    DataDifference
-    levenshteinMatrixToDeltas(const LevenshteinMatrix & matrix, const std::vector<T> &source, const std::vector<T> &destination,
-                              const std::string &dstFilename,
-                              const std::function<std::string(size_t idx)>& sourceDataDisplayFunction,
-                              const std::function<std::string(size_t idx)>& destinationDataDisplayFunction) const {
-        DataDifference result (filename, dstFilename, {}, ForcedOutput::Default);
-
-        size_t i = source.size(), j = destination.size();
-
-        while (i != 0 || j != 0) {
-            // Get neighbours: top, left, topleft. Choose smallest one.
-            // This will be part of the lowest edit distance.
-            std::optional<size_t> leftVal = {}, topVal = {}, leftTopVal = {};
-
-            if (i != 0) topVal = matrix.Get(i - 1, j);
-            if (j != 0) leftVal = matrix.Get(i, j - 1);
-            if (i != 0 && j != 0) leftTopVal = matrix.Get(i - 1, j - 1);
-
-            // I know that at least one of the optionals will have a value. Take minimum from those.
-            auto minimum = Utility::min<std::optional<size_t>>(leftVal, topVal, leftTopVal, Utility::cmpOptionals<size_t>);
-
-            if (minimum == leftTopVal) /* either no change or modification */ {
-                if (matrix.Get(i, j) ==
-                    matrix.Get(i - 1, j - 1)) {
-                    // No change, just follow the path for free
-                    i--;
-                    j--;
-                } else {
-                    // A change happened
-                    result.deltas.push_back(DataDelta(
-                                                    DataDeltaKind::Modification,
-                                                    {destinationDataDisplayFunction(j-1)},
-                                                    generateContext(i-1),
-                                                    i, j, 1, 1
-                        ));
-                    i--;
-                    j--;
+    EditScript diffWindow(const std::vector<T> &source, const std::vector<T> &destination, size_t jobs) const {
+        switch (options.algorithm) {
+            case Levenshtein: {
+                if (!options.precision.has_value()) return adaptiveLevenshteinEditScript(source, destination, jobs);
+                if constexpr (std::is_same<T, char>::value) {
+                    // Bytes are diffed 64 at a time, full matrix is never worth it
+                    if (*options.precision == 0) return BitParallelDiff::Diff(source, destination);
                 }
-            } else if (minimum == leftVal) /* addition */ {
-                result.deltas.push_back(DataDelta(
-                                                DataDeltaKind::Addition,
-                                                {destinationDataDisplayFunction(j-1)},
-                                                generateContext(i-1),
-                                                i, j, 0, 1
-                                        ));
-                j--;
-            } else if (minimum == topVal) /* deletion */ {
-                result.deltas.push_back(DataDelta(
-                                                DataDeltaKind::Deletion,
-                                                {sourceDataDisplayFunction(i-1)},
-                                                generateContext(i-1),
-                                                i, j, 1, 0
-                                        ));
-                i--;
-            } else {
-                throw std::logic_error(
-                        "Error while diffing: found a change in diff matrix that doesn't correspond to anything.");
+                if (*options.precision == 0 && (source.size() + 1) * (destination.size() + 1) > fullMatrixCellLimit) {
+                    logger.Log("Full levenshtein matrix would be too large, finding exact difference "
+                               "with linear-space Hirschberg algorithm instead.", Severity::Info);
+                    return HirschbergDiff::Diff(source, destination);
+                }
+                LevenshteinMatrix matrix = constructLevenshteinMatrix(source, destination, options.precision, jobs);
+                if (options.checkOptimality) {
+                    size_t distance = *matrix.Get(source.size(), destination.size());
+                    size_t bound = matrix.OutsideLowerBound();
+                    if (distance <= bound)
+                        logger.Log("Precision " + std::to_string(*options.precision) + " found provably minimal edit distance "
+                                   + std::to_string(distance) + ".", Severity::Info);
+                    else
+                        logger.Log("Precision " + std::to_string(*options.precision) + " found edit distance "
+                                   + std::to_string(distance) + ", which might not be minimal (lowest possible is "
+                                   + std::to_string(bound) + "). Use higher precision.", Severity::Warning);
+                }
+                return levenshteinMatrixToEditScript(matrix, source.size(), destination.size());
             }
+            case Myers:
+                return MyersDiff::Diff(source, destination);
+            case Hirschberg:
+                return HirschbergDiff::Diff(source, destination);
+            case Patience:
+                return PatienceDiff::Diff(source, destination);
+            case Histogram:
+                return HistogramDiff::Diff(source, destination);
+            default:
+                throw std::invalid_argument("Unknown diff algorithm.");
         }
+    }
+
+    /// Find minimal edit script between two vectors of chunks with levenshtein matrix, whose precision
+    /// is doubled until no cell outside of precision range could lower the found edit distance.
+    ///
+    /// Runs in O((N+M)*D), where D is the edit distance. Falls back to HirschbergDiff, if the matrix
+    /// would grow too large. Bytes fall back to BitParallelDiff instead, as soon as it would be faster.
+    ///
+    /// \tparam T The chunk type - typically string (for line) or char (for bytes). Can be even hashes or anything else.
+    /// \param source Vector of chunks of source file (or part of it).
+    /// \param destination Vector of chunks of destination file (or part of it).
+    /// \param jobs Count of threads filling levenshtein matrix, see DiffOptions.
+    /// \return Edit script with minimal levenshtein distance.
+    //
+    // This has to be implemented in header, bc of templates.
+    // The implementation of a non-specialized template must be visible to a translation unit that uses it.
+    template<typename T>
+    EditScript adaptiveLevenshteinEditScript(const std::vector<T> &source, const std::vector<T> &destination, size_t jobs) const {
+        size_t longer = std::max(source.size(), destination.size());
+        for (size_t precision = initialAdaptivePrecision; ; precision *= 2) {
+            // Band that covers whole matrix is the same as unlimited precision
+            if (precision >= longer) precision = 0;
+            size_t bandWidth = precision == 0 ? destination.size() + 1 : 2 * precision + 1;
+            if constexpr (std::is_same<T, char>::value) {
+                // Bit-parallel algorithm computes whole column of bytes in about as many steps as the band has words
+                if (bandWidth * bitParallelBandRatio > destination.size() || (source.size() + 1) * bandWidth > fullMatrixCellLimit) {
+                    logger.Log("Band of levenshtein matrix grew wide, finding exact difference "
+                               "with bit-parallel algorithm instead.", options.checkOptimality ? Severity::Info : Severity::Debug);
+                    return BitParallelDiff::Diff(source, destination);
+                }
+            }
+            if ((source.size() + 1) * bandWidth > fullMatrixCellLimit) {
+                logger.Log("Levenshtein matrix would be too large, finding exact difference "
+                           "with linear-space Hirschberg algorithm instead.", Severity::Info);
+                return HirschbergDiff::Diff(source, destination);
+            }
 
-        result.deltas.reverse();
-        return result;
+            LevenshteinMatrix matrix = constructLevenshteinMatrix(source, destination, precision, jobs);
+            size_t distance = *matrix.Get(source.size(), destination.size());
+            if (precision == 0 || distance <= matrix.OutsideLowerBound()) {
+                logger.Log("Found minimal edit distance " + std::to_string(distance) + " with precision "
+                           + std::to_string(precision) + ".", options.checkOptimality ? Severity::Info : Severity::Debug);
+                return levenshteinMatrixToEditScript(matrix, source.size(), destination.size());
+            }
+        }
     }
+
+    /// Find cheapest path from bottom-right corner of the levenshtein matrix to the top-left corner,
+    /// and record it as edit script.
+    ///
+    /// \param matrix Levenshtein matrix of the source and destination
+    /// \param sourceSize Count of chunks of source file.
+    /// \param destinationSize Count of chunks of destination file.
+    /// \return Edit script described by the matrix.
+    EditScript levenshteinMatrixToEditScript(const LevenshteinMatrix & matrix, size_t sourceSize, size_t destinationSize) const;
+
+    /// Describe edit script of part of the files as hunks of data difference.
+    ///
+    /// \param script Edit script from part of source to part of destination
+    /// \param srcFrom Index of the first source chunk of the part
+    /// \param dstFrom Index of the first destination chunk of the part
+    /// \param hunks Builder that merges adjacent edits of the same kind into hunks. Chunks are viewed
+    /// through display functions of its difference, see `diffChunks`.
+    void appendEditScript(const EditScript & script, size_t srcFrom, size_t dstFrom, HunkBuilder & hunks) const;
 };
@@ -3,13 +3,13 @@
 PPMFileDiffer::PPMFileDiffer(const std::string &filename, const LoadMode &mode, Logger &logger) :
     FileDiffer(mode, logger, {}, filename) {}
 
-std::optional<DataDifference> PPMFileDiffer::Diff(const FileDiffer &other) const {
-    if (!file) return {};
+bool PPMFileDiffer::Diff(const FileDiffer &other, DeltaSink &sink) const {
+    if (!file) return false;
 
     const auto *ppmRhs = dynamic_cast<const PPMFileDiffer *>(&other);
     if (ppmRhs == nullptr) {
         logger.Log("Cannot compare ppm data type (left) with non-ppm data type (right). Aborting.", Severity::Critical);
-        return {};
+        return false;
     }
 
     file->XORWith(*(ppmRhs->file));
@@ -17,19 +17,15 @@ std::optional<DataDifference> PPMFileDiffer::Diff(const FileDiffer &other) const
     std::ostringstream output;
     output << *file;
 
-    return DataDifference(
-            filename,
-            ppmRhs->filename,
-            {
-                    DataDelta(
-                            DataDeltaKind::Modification,
-                            {output.str()},
-                            {},
-                            0, 0, 0, 0
-                    )
-            },
-            ForcedOutput::DirectPrint
-    );
+    DataDifference difference(filename, ppmRhs->filename, {}, ForcedOutput::DirectPrint);
+    sink.Begin(difference);
+    sink.Delta(difference, DataDelta(DataDeltaKind::Modification, {output.str()}, {}, 0, 0, 0, 0));
+    sink.End(difference);
+    return true;
+}
+
+ForcedOutput PPMFileDiffer::OutputStyle() const {
+    return ForcedOutput::DirectPrint;
 }
 
 bool PPMFileDiffer::LoadData() {
@@ -12,7 +12,9 @@ class PPMFileDiffer : public FileDiffer {
 public:
     PPMFileDiffer(const std::string & filename, const LoadMode & mode, Logger & logger);
     bool LoadData() override;
-    std::optional<DataDifference> Diff(const FileDiffer & other) const override;
+    bool Diff(const FileDiffer & other, DeltaSink & sink) const override;
+    /// XOR'ed image is written directly, in the same file format
+    ForcedOutput OutputStyle() const override;
 
 private:
     DataContext generateContext(size_t offset) const override;
@@ -1,42 +1,53 @@
 #include "TextFileDiffer.h"
 
-TextFileDiffer::TextFileDiffer(const std::string & filename, const LoadMode & mode, std::optional<size_t> precision, Logger & logger) : FileDiffer(mode, logger, precision, filename) { }
+TextFileDiffer::TextFileDiffer(const std::string & filename, const LoadMode & mode, const DiffOptions & options, Logger & logger) : FileDiffer(mode, logger, options, filename) { }
 
-std::optional<DataDifference> TextFileDiffer::Diff(const FileDiffer &other) const {
+bool TextFileDiffer::Diff(const FileDiffer &other, DeltaSink &sink) const {
     const auto * textRhs = dynamic_cast<const TextFileDiffer *>(&other);
     if (textRhs == nullptr) {
         // TODO: downcast `other` to text?
         logger.Log("Cannot compare text data type (left) with non-text data type (right). Aborting.", Severity::Critical);
-        return {};
+        return false;
     }
 
-    LevenshteinMatrix matrix = constructLevenshteinMatrix(lineHashes, textRhs->lineHashes);
+    // Lines of both files, source lines first
+    auto anyLine = [this, textRhs](size_t idx) {
+        return idx < lineHashes.size() ? line(idx) : textRhs->line(idx - lineHashes.size());
+    };
+    TextNormalizer lhsNormalizer = normalizer(), rhsNormalizer = normalizer();
+    ChunkClasses classes = classifyChunks(lineHashes, textRhs->lineHashes, [&](size_t lhs, size_t rhs) {
+        return lhsNormalizer.Normalize(anyLine(lhs)) == rhsNormalizer.Normalize(anyLine(rhs));
+    });
 
-    DataDifference result = levenshteinMatrixToDeltas<u32>(matrix, lineHashes, textRhs->lineHashes, textRhs->filename,
-                                                           [this](size_t idx) -> std::string { return lines[idx]; },
-                                                           [textRhs](size_t idx) -> std::string { return textRhs->lines[idx]; });
+    diffChunks<u32>(classes.source, classes.destination, textRhs->filename,
+                    [this](size_t idx) { return line(idx); },
+                    [textRhs](size_t idx) { return textRhs->line(idx); },
+                    sink);
 
-    return result;
+    return true;
 }
 
 bool TextFileDiffer::LoadData() {
-    inputStream = std::ifstream(filename);
+    contents = MappedTextFile::Load(filename);
 
-    if(!inputStream) {
+    if(!contents) {
         logger.Log("Failed to read file \"" + filename + "\", make sure the file exists and is accessible.", Severity::Critical);
         return false;
     }
 
-    std::string line;
-    while(std::getline(inputStream, line)) {
-        lines.push_back(line);
-        lineHashes.push_back(Utility::Murmur3(normalizeText(line)));
+    size_t lineCount = contents->LineCount();
+    lineHashes.reserve(lineCount);
+    // Strict lines are hashed directly from the file contents, others from one reused buffer
+    TextNormalizer lineNormalizer = normalizer();
+    for (size_t idx = 0; idx < lineCount; idx++) {
+        lineHashes.push_back(Utility::Hash64(lineNormalizer.Normalize(line(idx))));
     }
 
-    if (lines.empty()) {
+    // Missing side of an added or deleted file is /dev/null on purpose
+    if (lineCount == 0 && options.warnEmptyFiles && filename != "/dev/null") {
         logger.Log("No lines were read from \"" + filename + "\", is the file empty?", Severity::Warning);
     }
-    logger.Log("File \"" + filename + "\" loaded successfully. Loaded total of " + std::to_string(lines.size()) + " lines.", Severity::Debug);
+    logger.Log("File \"" + filename + "\" loaded successfully. Loaded total of " + std::to_string(lineCount) + " lines" + (contents->IsMapped() ? "" : " (not mapped to memory)") + ".", Severity::Debug);
     return true;
 }
 
@@ -44,28 +55,11 @@ DataContext TextFileDiffer::generateContext(size_t offset) const {
     const size_t context_before_len = 4;
     const size_t context_after_len = 2;
 
-    DataContext result;
-
-    result.rawData = Utility::vectorSlice(lines, (offset - context_before_len > offset) ? 0 : (offset - context_before_len), offset + context_after_len);
-
-    size_t lastBeforeIndexIncl = std::min((offset < context_after_len) ? offset : context_before_len, offset);
-    result.maxIdxOfBeforeContext = lastBeforeIndexIncl;
-    result.maxIdxOfOnContext = result.maxIdxOfBeforeContext + 1; // Assume one line changed
-
-    return result;
+    return DataContext(offset, contents->LineCount(), context_before_len, context_after_len);
 }
 
-std::string TextFileDiffer::normalizeText(std::string text) const {
-    if (!(int)(LoadMode::Text_StrictWhitespace & mode)) {
-        // No strict whitespaces, ignore them
-        text.erase(remove_if(text.begin(), text.end(), isspace), text.end());
-    }
-
-    if (!(int)(LoadMode::Text_StrictCase & mode)) {
-        // No strict case, ignore case
-        transform(text.begin(), text.end(), text.begin(), tolower);
-    }
-
-    return text;
+TextNormalizer TextFileDiffer::normalizer() const {
+    // No strict whitespaces, ignore them. No strict case, ignore case.
+    return TextNormalizer(!(int)(LoadMode::Text_StrictWhitespace & mode), !(int)(LoadMode::Text_StrictCase & mode));
 }
 
@@ -5,27 +5,31 @@
 #include <algorithm>
 
 #include "FileDiffer.h"
+#include "DataStructures/MappedTextFile.h"
+#include "Algorithms/TextNormalizer.h"
 
 class TextFileDiffer : public FileDiffer {
     typedef u_int32_t u32;
 
-    std::vector<std::string> lines;
-    /// Murmur3 hash of each line, used to quickly determine,
+    /// Contents of the file, lines are views into it.
+    std::optional<MappedTextFile> contents;
+    /// 64-bit hash of each normalized line, used to quickly determine,
     /// whether two lines are equal.
     ///
-    /// Regarding hash collisions: we might compare
-    /// the line char-by-char on hash hit in order to
-    /// prevent false positive matches, but we don't really
-    /// need to b/c of Murmur3 properties and because
-    /// this is mere file differ.
-    std::vector<u32> lineHashes;
+    /// Regarding hash collisions: lines are compared
+    /// char-by-char on hash hit only with `--verify-hashes`,
+    /// collision of 64-bit hashes is not expected otherwise.
+    std::vector<Utility::u64> lineHashes;
 
 public:
-    TextFileDiffer(const std::string & filename, const LoadMode & mode, std::optional<size_t> precision, Logger & logger);
+    TextFileDiffer(const std::string & filename, const LoadMode & mode, const DiffOptions & options, Logger & logger);
     bool LoadData() override;
-    std::optional<DataDifference> Diff(const FileDiffer & other) const override;
+    bool Diff(const FileDiffer & other, DeltaSink & sink) const override;
 
 private:
-    std::string normalizeText(std::string text) const;
+    /// Normalizer of lines, that skips whitespace and folds case, unless the mode is strict.
+    TextNormalizer normalizer() const;
+    /// View of line at given index, valid as long as this differ exists.
+    std::string_view line(size_t idx) const { return contents->Line(idx); }
     DataContext generateContext(size_t offset) const override;
 };
@@ -2,8 +2,10 @@
 
 void StderrLogger::Log(const std::string &text, const Severity & severity) {
     // Ignore log attempts with lower severity than is currently set up.
-    if (severity >= lowestSeverityToDisplay)
+    if (severity >= lowestSeverityToDisplay) {
+        std::lock_guard<std::mutex> lock(mutex);
         std::cerr << "[" << getAnsiColorFromSeverity(severity) << severity << Utility::Colors::ansi_reset << "] " << text << std::endl;
+    }
 }
 
 void StderrLogger::ChangeSeverity(const Severity &targetSeverity) {
@@ -1,11 +1,14 @@
 #pragma once
 
 #include <iostream>
+#include <mutex>
 
 #include "Logger.h"
 #include "../Utility.cpp"
 
 class StderrLogger : public Logger {
+    /// Logs may come from multiple threads, one line is written at a time
+    std::mutex mutex;
 
 public:
     explicit StderrLogger(Severity lowestSeverityToDisplay) : Logger(std::move(lowestSeverityToDisplay)) {}
@@ -0,0 +1,101 @@
+#include "ThreadPool.h"
+
+thread_local ThreadPool * ThreadPool::currentPool = nullptr;
+thread_local size_t ThreadPool::currentWorker = 0;
+
+ThreadPool::ThreadPool(size_t threads) {
+    if (threads == 0) threads = HardwareThreads();
+    queues.reserve(threads);
+    for (size_t i = 0; i < threads; ++i) queues.push_back(std::make_unique<TaskQueue>());
+    workers.reserve(threads);
+    for (size_t i = 0; i < threads; ++i)
+        workers.emplace_back(&ThreadPool::work, this, i);
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    taskAvailable.notify_all();
+    for (auto & worker : workers) worker.join();
+}
+
+size_t ThreadPool::HardwareThreads() {
+    size_t threads = std::thread::hardware_concurrency();
+    return threads == 0 ? 1 : threads;
+}
+
+void ThreadPool::Submit(std::function<void()> task) {
+    {
+        // Counted as pending before it can run, so Wait cannot miss it
+        std::lock_guard<std::mutex> lock(mutex);
+        pending++;
+    }
+    TaskQueue & queue = currentPool == this ? *queues[currentWorker] : injected;
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.tasks.push_back(std::move(task));
+    }
+    {
+        // Counted as queued only once it can be taken, under the mutex, so no sleeping worker misses it
+        std::lock_guard<std::mutex> lock(mutex);
+        queued++;
+    }
+    taskAvailable.notify_one();
+}
+
+void ThreadPool::Wait() {
+    std::unique_lock<std::mutex> lock(mutex);
+    allFinished.wait(lock, [this] { return pending == 0; });
+    if (error) {
+        std::exception_ptr thrown = error;
+        error = nullptr;
+        std::rethrow_exception(thrown);
+    }
+}
+
+bool ThreadPool::takeTask(size_t index, std::function<void()> & task) {
+    auto take = [&task](TaskQueue & queue, bool newest) {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.tasks.empty()) return false;
+        if (newest) {
+            task = std::move(queue.tasks.back());
+            queue.tasks.pop_back();
+        } else {
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+        }
+        return true;
+    };
+
+    if (take(*queues[index], true) || take(injected, false)) return true;
+    for (size_t i = 1; i < queues.size(); ++i)
+        if (take(*queues[(index + i) % queues.size()], false)) return true;
+    return false;
+}
+
+void ThreadPool::work(size_t index) {
+    currentPool = this;
+    currentWorker = index;
+    while (true) {
+        std::function<void()> task;
+        if (!takeTask(index, task)) {
+            std::unique_lock<std::mutex> lock(mutex);
+            taskAvailable.wait(lock, [this] { return stopping || queued > 0; });
+            if (stopping && queued <= 0) return;
+            continue;
+        }
+        queued--;
+
+        try {
+            task();
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!error) error = std::current_exception();
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (--pending == 0) allFinished.notify_all();
+    }
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/// Fixed set of worker threads, that run submitted tasks.
+///
+/// Tasks may submit further tasks. Wait blocks until all of them,
+/// including the ones submitted later, are finished.
+///
+/// Each worker has its own queue of tasks. Tasks submitted by a worker go to its own queue,
+/// and the worker runs the newest of them first (so a task walking a tree descends depth-first,
+/// with the data it just touched still in cache). A worker without tasks takes the oldest task
+/// submitted from outside of the pool, or steals the oldest task of another worker, so one worker
+/// that submits many tasks is helped by all the others.
+class ThreadPool {
+    /// Tasks waiting to be run, guarded by its own mutex, so workers rarely wait on each other
+    struct TaskQueue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    std::vector<std::thread> workers;
+    /// Queue of each worker, the worker pushes and takes at the back, others steal at the front
+    std::vector<std::unique_ptr<TaskQueue>> queues;
+    /// Tasks submitted from outside of the pool, run in order of submission
+    TaskQueue injected;
+    /// Guards [pending], [stopping] and [error], and changes of [queued] that wake workers up
+    std::mutex mutex;
+    /// Notified when a task is submitted, or the pool is stopping
+    std::condition_variable taskAvailable;
+    /// Notified when the last pending task finishes
+    std::condition_variable allFinished;
+    /// Count of tasks in the queues. Taking a task may be counted before its submission is,
+    /// so the count may be negative for a moment.
+    std::atomic<std::ptrdiff_t> queued{0};
+    /// Count of tasks submitted and not finished yet
+    size_t pending = 0;
+    bool stopping = false;
+    /// First exception thrown by a task, rethrown by Wait
+    std::exception_ptr error;
+
+    /// Pool of the worker running on current thread, if any, and index of the worker
+    static thread_local ThreadPool * currentPool;
+    static thread_local size_t currentWorker;
+
+public:
+    /// Start worker threads.
+    ///
+    /// \param threads Count of threads, 0 means one per hardware thread.
+    explicit ThreadPool(size_t threads);
+    ~ThreadPool();
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool & operator=(const ThreadPool &) = delete;
+
+    /// Count of hardware threads, at least 1.
+    static size_t HardwareThreads();
+
+    /// Count of worker threads of the pool.
+    size_t Size() const { return workers.size(); }
+
+    /// Queue task to be run by one of the workers.
+    void Submit(std::function<void()> task);
+
+    /// Wait until all submitted tasks are finished.
+    /// Rethrows first exception thrown by any of them.
+    void Wait();
+
+private:
+    /// Run tasks until the pool is stopping
+    ///
+    /// \param index Index of the worker, and of its queue
+    void work(size_t index);
+    /// Take next task for the given worker: its newest own task, the oldest task submitted from outside,
+    /// or the oldest task of another worker, in this order.
+    ///
+    /// \param index Index of the worker
+    /// \param task Set to the taken task
+    /// \return Whether any task was taken
+    bool takeTask(size_t index, std::function<void()> & task);
+};
@@ -1,5 +1,8 @@
 #include <functional>
 #include <string>
+#include <string_view>
+#include <cstdint>
+#include <cstring>
 #include <iomanip>
 #include <iostream>
 #include <optional>
@@ -146,6 +149,101 @@ namespace Utility {
 
         return hash;
     }
+
+    typedef uint64_t u64;
+
+    /// Building blocks of [Hash64]
+    namespace Hash64Detail {
+        __extension__ typedef unsigned __int128 u128;
+
+        /// Constants mixed into the input, so no input is multiplied by zero by accident
+        constexpr u64 secret[8] = {
+                0xbe4ba423396cfeb8, 0x1cad21f72c81017c, 0xdb979083e96dd4de, 0x1f67b3b7a4a44072,
+                0x78e5c0cc4ee679cb, 0x2172ffcc7dd05a82, 0x8e2443f7744608b8, 0x4c263a81e69035e0,
+        };
+        constexpr u64 prime1 = 0x9e3779b185ebca87, prime2 = 0xc2b2ae3d27d4eb4f, prime3 = 0x165667919e3779f9;
+
+        inline u64 read64(const char * data) { u64 value; memcpy(&value, data, sizeof(value)); return value; }
+        inline u64 read32(const char * data) { uint32_t value; memcpy(&value, data, sizeof(value)); return value; }
+
+        /// Full 128-bit product of two numbers, folded into 64 bits
+        inline u64 multiplyFold(u64 lhs, u64 rhs) {
+            u128 product = (u128)lhs * rhs;
+            return (u64)product ^ (u64)(product >> 64);
+        }
+
+        /// Spread every bit of the accumulator over the whole hash
+        inline u64 avalanche(u64 hash) {
+            hash ^= hash >> 37;
+            hash *= prime3;
+            hash ^= hash >> 32;
+            return hash;
+        }
+    }
+
+    /// Hash bytes into 64 bits, using technique based on XXH3 hash.
+    ///
+    /// Short inputs (typical lines) are hashed by a few multiplications, without any loop.
+    /// Longer ones are read 32 bytes per step, into two independent accumulators, each
+    /// mixing 16 bytes by one 64x64->128 bit multiplication.
+    ///
+    /// This is NOT cryptographically secure, and does not produce the same values as XXH3.
+    ///
+    /// Source: https://github.com/Cyan4973/xxHash/blob/dev/doc/xxhash_spec.md
+    ///
+    /// \param data Start of the bytes to hash
+    /// \param length Count of the bytes
+    /// \return 64-bit hash, unlike [Murmur3], collisions are not expected even among billions of inputs.
+    inline u64 Hash64(const char * data, size_t length) noexcept {
+        using namespace Hash64Detail;
+        if (length <= 16) {
+            if (length > 8) {
+                u64 low = read64(data) ^ secret[0], high = read64(data + length - 8) ^ (secret[1] - length);
+                return avalanche(length + __builtin_bswap64(low) + high + multiplyFold(low, high));
+            }
+            if (length >= 4) {
+                u64 input = read32(data + length - 4) + (read32(data) << 32);
+                return avalanche(multiplyFold(input ^ secret[2], prime1) ^ (length * prime2));
+            }
+            if (length > 0) {
+                u64 input = ((u64)(unsigned char)data[0] << 16) | ((u64)(unsigned char)data[length >> 1] << 24)
+                            | (u64)(unsigned char)data[length - 1] | ((u64)length << 8);
+                return avalanche(multiplyFold(input ^ secret[3], prime1));
+            }
+            return avalanche(secret[4] ^ secret[5]);
+        }
+
+        u64 accumulator = length * prime1, second = secret[7];
+        const char * position = data;
+        const char * end = data + length;
+        while (end - position > 32) {
+            accumulator += multiplyFold(read64(position) ^ secret[0], read64(position + 8) ^ secret[1]);
+            second += multiplyFold(read64(position + 16) ^ secret[2], read64(position + 24) ^ secret[3]);
+            position += 32;
+        }
+        // Last 32 bytes (or the first and last 16 bytes of shorter inputs), overlapping the ones already read
+        const char * tail = length >= 32 ? end - 32 : data;
+        accumulator += multiplyFold(read64(tail) ^ secret[4], read64(tail + 8) ^ secret[5]);
+        second += multiplyFold(read64(end - 16) ^ secret[6], read64(end - 8) ^ secret[7]);
+        return avalanche(accumulator + multiplyFold(second ^ prime2, length ^ prime1));
+    }
+
+    /// Hash text into 64 bits, see [Hash64].
+    inline u64 Hash64(std::string_view text) noexcept {
+        return Hash64(text.data(), text.size());
+    }
+
+    /// Mix hash of next part of the data into hash of the preceding parts, so data read
+    /// part by part (such as a file, block by block) is hashed without being held whole.
+    /// The result depends on the order of the parts.
+    ///
+    /// \param hash Hash of the preceding parts, [Hash64] of no bytes for the first part
+    /// \param next [Hash64] of the next part
+    /// \return Hash of all the parts so far
+    inline u64 Hash64Combine(u64 hash, u64 next) noexcept {
+        using namespace Hash64Detail;
+        return avalanche(multiplyFold(hash ^ secret[6], next ^ secret[7]) + next);
+    }
 }
 #endif /* UTILITY */
 
@@ -20,15 +20,25 @@ int main(int argc, char ** argv) {
         return 0;
     }
 
-    if (arguments->verbosity > 0) logger.ChangeSeverity((Severity::Info));
+    // Optimality is reported as info, so make sure user can see it
+    if (arguments->verbosity > 0 || arguments->diffOptions.checkOptimality) logger.ChangeSeverity((Severity::Info));
     if (arguments->verbosity > 1) logger.ChangeSeverity((Severity::Debug));
 
     try {
         Diffeek app(*arguments, logger);
         if(!app.LoadData(logger)) return 2;
-        std::optional<DataDifference> data = app.Diff();
-        if(!data) /* something failed */ return 3;
-        if(!DataOutput::GetOutput(*arguments, *data, logger)->Write(*data)) return 4;
+        if (arguments->binaryDelta || arguments->applyDelta) {
+            // Delta (or the patched file) is binary, it is written as it is
+            OutputBuffer out(STDOUT_FILENO);
+            bool success = arguments->binaryDelta ? app.WriteDelta(out, logger) : app.ApplyDelta(out, logger);
+            if (!success) return 3;
+            if (!out.Flush()) return 4;
+            return 0;
+        }
+        // Hunks are written as soon as they are found
+        std::unique_ptr<DataOutput> output = DataOutput::GetOutput(*arguments, app.OutputStyle(), logger);
+        if(!app.Diff(*output, logger)) /* something failed */ return 3;
+        if(!output->Good()) return 4;
     } catch (const std::exception & e) {
         std::cerr << "A fatal uncaught error occurred while diffing. Aborting." << std::endl;
         std::cerr << e.what() << std::endl;
@@ -51,7 +61,18 @@ void help() {
     cout << "\t-F format\t\tforce specific fileformat (text, binary, directory, ppm, ...). Refer to manpage for exhaustive list." << endl;
     cout << "\t-s\t\tstrict mode: don't ignore atribute order in structured files. Also implies --text-strictcase and --text-strictwhitespace." << endl;
     cout << "\t--text-strictcase,\n\t--text-strictwhitespace\t\tdo not ignore case / whitespaces when comparing text files." << endl;
-    cout << "\t-x N\t\t--precision N\t\tset diffing precision to N, where N >= 2 (default: 1/25 of sum of lines of a file). This affects speed/minimal found edit distance. Set to 0 for unlimited precision." << endl;
+    cout << "\t-x N\t\t--precision N\t\tset diffing precision to N, where N >= 2 (default: widened automatically until the edit distance is minimal). This affects speed/minimal found edit distance. Set to 0 for unlimited precision (large inputs are then diffed in linear memory)." << endl;
+    cout << "\t-j N\t\t--jobs N\t\tdiff independent parts of the files, fill large levenshtein matrices, or read and hash files of directories, with N threads. 0 means one per CPU core (default: 1). The result is the same for any N." << endl;
+    cout << "\t--split-anchors\t\tsplit files at lines unique to both of them, and diff the parts independently (and concurrently, see --jobs). Much faster for large files, but the result might not be minimal." << endl;
+    cout << "\t--delta\t\twrite compact binary delta from the first file to the second one, where moved data is copied instead of deleted and added. Any files are compared as binary." << endl;
+    cout << "\t--apply\t\tapply binary delta (written by --delta) given as the second file to the first file, and write the result." << endl;
+    cout << "\t--chunked\t\tsplit binary files into content-defined chunks, and diff byte by byte only the chunks that differ. Used for files of 16 MB and more even without it. Fast for very large files, but the result might not be minimal." << endl;
+    cout << "\t-r\t\t--recursive\t\tdiff contents of every changed file of the two directories, as files of its own format, concurrently with --jobs. Deleted and added files are diffed against /dev/null, including the ones moved or renamed (--renames is ignored)." << endl;
+    cout << "\t--renames\t\tcompare directories by names of the files in one pass, and list added, deleted and modified files and directories, and the ones moved or renamed with unchanged content, instead of the difference of the file listings." << endl;
+    cout << "\t--hash-cache FILE\t\tremember hashes of files of compared directories in FILE, and do not read files that have not changed (same device, inode, size and modification time) since then." << endl;
+    cout << "\t--verify-hashes\t\tcompare lines themselves when their hashes are equal, instead of trusting the 64-bit hash." << endl;
+    cout << "\t--check-optimality\t\treport whether levenshtein matrix found provably minimal edit distance with given precision." << endl;
+    cout << "\t-a name\t\t--algorithm name\t\tset diffing algorithm: levenshtein (default, respects precision), myers (fast when files are similar, always finds shortest edit script without modifications) hirschberg (exact levenshtein distance in linear memory), patience or histogram (anchored on rare lines, fast and readable for source code)." << endl;
     cout << "\t-p\t\tpatchfile output: force output in form of patchfile (this is the default when outputing to a file)" << endl;
     cout << "\t-g\t\tgraphical output: force output in graphical, user-friendly mode (this is the default when outputing to tty)" << endl;
     cout << endl;